@@ -0,0 +1,43 @@
+//
+// BatchQueue.h (host)
+// spread independent jobs over all cores
+
+// Workers pull the next job number from a shared counter, so long and short
+// jobs balance themselves.  Each job runs entirely on one thread; with the
+// host Arduino stand-in that thread also gets its own clock and pins.
+//
+//   runBatch(sessions.size(), 0, [&](size_t i) { analyze(sessions[i]); });
+
+#ifndef __BATCH_QUEUE_H__
+#define __BATCH_QUEUE_H__
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Run job(0) .. job(count - 1) on `threads` threads (0: one per core).
+template <typename Job>
+void runBatch(size_t count, unsigned threads, Job job)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+    if (threads > count)
+        threads = count;
+
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for (size_t i; (i = next++) < count; )
+            job(i);
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; t++)
+        pool.emplace_back(worker);
+    worker(); // this thread works too
+    for (size_t t = 0; t < pool.size(); t++)
+        pool[t].join();
+}
+
+#endif // __BATCH_QUEUE_H__
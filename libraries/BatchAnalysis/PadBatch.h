@@ -0,0 +1,142 @@
+//
+// PadBatch.h (host)
+// QuadPressurePad's moving average and touch test for many channels at once
+
+// Every channel is one pad of one session.  step() feeds all channels one
+// sample each and computes every moving average; AVX2 does 8 channels per
+// instruction where the CPU has it, plain C++ otherwise.
+//
+// Results are bit-identical to QuadPressurePad:
+//   1) same ring of NUM_SAMPLES slots, written in the same order
+//   2) the device sums double(x) / NUM_SAMPLES into an int16_t, truncating
+//      after every term, in slot order.  sum + x/16 is exact in a double, so
+//      that is the integer (16 * sum + x) / 16, rounded toward zero -- which
+//      is what both paths here compute.
+//   3) touched() is the device's |sample - average| > threshold
+// Readings are assumed to be ADC values (0..4095), as on the device.
+//
+//   PadBatch batch(4 * sessions);
+//   for each sample time:
+//       batch.step(samples);          // samples[channel]
+//       batch.averages()[channel] ...
+//       PadBatch::touched(samples[c], batch.averages()[c], 100) ...
+
+#ifndef __PAD_BATCH_H__
+#define __PAD_BATCH_H__
+
+#include "QuadPressurePad.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define PAD_BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+class PadBatch {
+
+    public:
+
+        static const uint8_t NUM_SAMPLES{QuadPressurePad::NUM_SAMPLES};
+        static const size_t LANES{8}; // int32 lanes per AVX2 register
+
+        explicit PadBatch(size_t channels, bool allowSimd = true)
+            : numChannels(channels),
+              stride((channels + LANES - 1) / LANES * LANES),
+              history(NUM_SAMPLES * stride, 0),
+              avg(stride, 0),
+              historyIndex(0),
+              simd(allowSimd && haveAVX2())
+        {
+        }
+
+        // Back to an empty history, as a freshly constructed QuadPressurePad.
+        void reset(void)
+        {
+            std::fill(history.begin(), history.end(), 0);
+            std::fill(avg.begin(), avg.end(), 0);
+            historyIndex = 0;
+        }
+
+        // One sample per channel; updates averages().
+        void step(const int16_t* samples)
+        {
+            std::copy(samples, samples + numChannels, &history[historyIndex * stride]);
+            historyIndex = (historyIndex + 1) % NUM_SAMPLES;
+#if defined(PAD_BATCH_X86)
+            if (simd) {
+                averageAVX2(&history[0], &avg[0], stride);
+                return;
+            }
+#endif
+            averageScalar(&history[0], &avg[0], stride);
+        }
+
+        // The moving average of each channel, including the last sample.
+        inline const int16_t* averages(void) const { return &avg[0]; }
+
+        // QuadPressurePad's touch test for one pad.
+        static inline bool touched(int16_t sample, int16_t average, int16_t threshold)
+        {
+            int16_t deviation = sample - average;
+            if (deviation < 0)
+                deviation *= -1;
+            return deviation > threshold;
+        }
+
+        inline size_t channels(void) const { return numChannels; }
+        inline bool usingSimd(void) const { return simd; }
+
+        static bool haveAVX2(void)
+        {
+#if defined(PAD_BATCH_X86)
+            return __builtin_cpu_supports("avx2");
+#else
+            return false;
+#endif
+        }
+
+    private:
+
+        static void averageScalar(const int16_t* hist, int16_t* out, size_t stride)
+        {
+            for (size_t c = 0; c < stride; c++) {
+                int32_t sum = 0;
+                for (uint8_t k = 0; k < NUM_SAMPLES; k++)
+                    sum = (sum * NUM_SAMPLES + hist[k * stride + c]) / NUM_SAMPLES;
+                out[c] = sum;
+            }
+        }
+
+#if defined(PAD_BATCH_X86)
+        __attribute__((target("avx2")))
+        static void averageAVX2(const int16_t* hist, int16_t* out, size_t stride)
+        {
+            static_assert(NUM_SAMPLES == 16, "averageAVX2 divides by shifting 4");
+            const __m256i roundTowardZero = _mm256_set1_epi32(NUM_SAMPLES - 1);
+            for (size_t c = 0; c < stride; c += LANES) {
+                __m256i sum = _mm256_setzero_si256();
+                for (uint8_t k = 0; k < NUM_SAMPLES; k++) {
+                    __m128i h16 = _mm_loadu_si128((const __m128i*)(hist + k * stride + c));
+                    __m256i t = _mm256_add_epi32(_mm256_slli_epi32(sum, 4), _mm256_cvtepi16_epi32(h16));
+                    // arithmetic shift rounds down; add 15 first to negatives
+                    __m256i bias = _mm256_and_si256(_mm256_srai_epi32(t, 31), roundTowardZero);
+                    sum = _mm256_srai_epi32(_mm256_add_epi32(t, bias), 4);
+                }
+                __m256i packed = _mm256_packs_epi32(sum, sum);     // 0-3 0-3 | 4-7 4-7
+                packed = _mm256_permute4x64_epi64(packed, 0x08);   // 0-3 4-7 | ...
+                _mm_storeu_si128((__m128i*)(out + c), _mm256_castsi256_si128(packed));
+            }
+        }
+#endif
+
+        size_t numChannels;
+        size_t stride;                 // channels rounded up to whole registers
+        std::vector<int16_t> history;  // [slot][channel]
+        std::vector<int16_t> avg;      // [channel]
+        uint8_t historyIndex;          // next slot to write
+        bool simd;
+
+}; // class PadBatch
+
+#endif // __PAD_BATCH_H__
@@ -0,0 +1,282 @@
+//
+// batch_analyze.cpp (host)
+// Runs the device's touch detection and switch debouncing over many recorded
+// sessions, for a sweep of touch thresholds, on every core.
+//
+// build: see ../../README.md
+//
+// run:
+//   ./batch_analyze session1.trace session2.trace ...   > results.csv
+//   ./batch_analyze -t 50,100,150,200 -p 1000 lab/*.trace > sweep.csv
+//   ./batch_analyze -n 2000 --verify                     # synthesized sessions
+//
+// options:
+//   -t a,b,...   touch thresholds to try (default 100, the device default)
+//   -p micros    loop() period the device ran at (default 1000)
+//   -j threads   worker threads (default: one per core)
+//   -n count     analyze `count` synthesized sessions instead of files
+//   --scalar     don't use AVX2
+//   --verify     also run the real QuadPressurePad over every session and
+//                check that every average and touch matches; exit 1 if not
+//
+// Sessions are PinTrace files with the examples/capture pin map: pads on
+// A0-A3, a switch on pin 2.  Each session is sampled every -p microseconds,
+// exactly as loop() would have seen it.  Switches go through the real
+// SimpleSwitch and SoftwareSwitch classes; pads go through PadBatch, 8
+// sessions (32 pads) at a time.
+//
+// Output, one CSV row per session and threshold:
+//   session,samples,threshold,touch_samples,touch_onsets,simple_presses,software_presses
+
+#include "PinTraceReplay.h"
+#include "PadBatch.h"
+#include "BatchQueue.h"
+#include "SimpleSwitch.h"
+#include "SoftwareSwitch.h"
+
+#include <chrono>
+#include <string>
+
+static const uint8_t SWITCH_PIN{2};
+static const uint8_t PAD_PIN[4] = {A0, A1, A2, A3};
+static const size_t SESSIONS_PER_JOB{8};
+
+struct Options {
+    std::vector<int16_t> thresholds;
+    uint32_t period = 1000;
+    unsigned threads = 0;
+    size_t synthesized = 0;
+    bool simd = true;
+    bool verify = false;
+    std::vector<const char*> files;
+};
+
+// What one session looked like to loop(): pad readings, and the switches.
+struct Session {
+    std::string name;
+    std::vector<int16_t> pads; // [sample][pad]
+    uint32_t simplePresses = 0;
+    uint32_t softwarePresses = 0;
+    bool ok = false;
+    size_t samples(void) const { return pads.size() / 4; }
+};
+
+struct Result {
+    uint32_t touchSamples = 0;
+    uint32_t touchOnsets = 0;
+};
+
+static uint32_t lcg(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Noisy pads with a touch now and then, 20-80 seconds long.
+static void synthesize(PinTraceReplay& trace, size_t index)
+{
+    uint32_t seed = 1000 + index;
+    uint64_t end = (20 + lcg(seed) % 60) * 1000000ull;
+    trace.add(0, SWITCH_PIN, false, 1);
+    for (uint64_t t = 0; t < end; t += 500) {
+        bool touch = (t / 100000) % 9 == 4;
+        for (uint8_t i = 0; i < 4; i++) {
+            int v = 280 + 10 * i + (int)(lcg(seed) % 25) - 12;
+            if (touch && (t / 900000) % 4 == i)
+                v += 100 + lcg(seed) % 200;
+            trace.add(t, PAD_PIN[i], true, v);
+        }
+        if (t % 250000 == 100000)
+            trace.add(t, SWITCH_PIN, false, (t / 250000) % 2);
+    }
+}
+
+// Replay one session at the loop() period on this thread's simulated pins.
+static void load(Session& s, const Options& opt, size_t index)
+{
+    PinTraceReplay trace;
+    if (opt.synthesized) {
+        synthesize(trace, index);
+        s.name = "synth" + std::to_string(index);
+    } else {
+        s.name = opt.files[index];
+        if (!trace.load(opt.files[index])) {
+            fprintf(stderr, "%s: can't read trace (line %lu)\n", opt.files[index], trace.errorAt());
+            return;
+        }
+    }
+
+    HostHAL::reset();
+    trace.rewind();
+    trace.advanceTo(trace.startTime());
+    SimpleSwitch simple(SWITCH_PIN);
+    SoftwareSwitch software(SWITCH_PIN);
+    software.begin(10000);
+
+    s.pads.reserve((trace.endTime() - trace.startTime()) / opt.period * 4 + 4);
+    for (uint64_t t = trace.startTime(); t <= trace.endTime(); t += opt.period) {
+        trace.advanceTo(t);
+        for (uint8_t i = 0; i < 4; i++)
+            s.pads.push_back(analogRead(PAD_PIN[i]));
+        simple.update();
+        software.update();
+        s.simplePresses += simple.pressed();
+        s.softwarePresses += software.isPressed();
+    }
+    s.ok = true;
+}
+
+// Run PadBatch over a group of sessions in lockstep.
+// results[session][threshold]
+static void analyze(const std::vector<Session>& group, const Options& opt,
+                    std::vector<std::vector<Result> >& results)
+{
+    const size_t numThresholds = opt.thresholds.size();
+    size_t longest = 0;
+    for (size_t s = 0; s < group.size(); s++)
+        longest = std::max(longest, group[s].samples());
+
+    PadBatch batch(4 * group.size(), opt.simd);
+    std::vector<int16_t> samples(4 * group.size(), 0);
+    std::vector<uint8_t> wasTouched(group.size() * numThresholds, 0);
+    results.assign(group.size(), std::vector<Result>(numThresholds));
+
+    for (size_t n = 0; n < longest; n++) {
+        for (size_t s = 0; s < group.size(); s++)
+            if (n < group[s].samples())
+                std::copy(&group[s].pads[4 * n], &group[s].pads[4 * n + 4], &samples[4 * s]);
+        batch.step(&samples[0]);
+        const int16_t* avg = batch.averages();
+
+        for (size_t s = 0; s < group.size(); s++) {
+            if (n >= group[s].samples())
+                continue;
+            for (size_t k = 0; k < numThresholds; k++) {
+                bool touched = false;
+                for (uint8_t i = 0; i < 4; i++)
+                    touched |= PadBatch::touched(samples[4 * s + i], avg[4 * s + i], opt.thresholds[k]);
+                Result& r = results[s][k];
+                uint8_t& was = wasTouched[s * numThresholds + k];
+                r.touchSamples += touched;
+                r.touchOnsets += touched && !was;
+                was = touched;
+            }
+        }
+    }
+}
+
+// The real device class, one update() per sample, compared with PadBatch.
+// Return the number of samples that differ.
+static size_t verify(const Session& s, const Options& opt)
+{
+    size_t mismatches = 0;
+    for (size_t k = 0; k < opt.thresholds.size(); k++) {
+        QuadPressurePad pad(PAD_PIN[0], PAD_PIN[1], PAD_PIN[2], PAD_PIN[3]);
+        pad.setSensitivity(opt.thresholds[k]);
+        PadBatch batch(4, opt.simd);
+        for (size_t n = 0; n < s.samples(); n++) {
+            const int16_t* x = &s.pads[4 * n];
+            pad.update(x);
+            batch.step(x);
+            bool touched = false;
+            bool same = true;
+            for (uint8_t i = 0; i < 4; i++) {
+                touched |= PadBatch::touched(x[i], batch.averages()[i], opt.thresholds[k]);
+                same &= pad.averages()[i] == batch.averages()[i];
+            }
+            if (!same || pad.isTouched() != touched)
+                mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+static bool parseArgs(int argc, char** argv, Options& opt)
+{
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        bool more = i + 1 < argc;
+        if (a == "-t" && more) {
+            for (char* p = strtok(argv[++i], ","); p; p = strtok(0, ","))
+                opt.thresholds.push_back(atoi(p));
+        } else if (a == "-p" && more) {
+            opt.period = strtoul(argv[++i], 0, 10);
+        } else if (a == "-j" && more) {
+            opt.threads = strtoul(argv[++i], 0, 10);
+        } else if (a == "-n" && more) {
+            opt.synthesized = strtoul(argv[++i], 0, 10);
+        } else if (a == "--scalar") {
+            opt.simd = false;
+        } else if (a == "--verify") {
+            opt.verify = true;
+        } else if (a[0] == '-') {
+            return false;
+        } else {
+            opt.files.push_back(argv[i]);
+        }
+    }
+    if (opt.thresholds.empty())
+        opt.thresholds.push_back(100);
+    return opt.period > 0 && (opt.synthesized > 0) != !opt.files.empty();
+}
+
+int main(int argc, char** argv)
+{
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        fprintf(stderr, "usage: %s [-t a,b,...] [-p micros] [-j threads] [--scalar] [--verify]"
+                        " (-n count | session.trace ...)\n", argv[0]);
+        return 2;
+    }
+
+    const size_t numSessions = opt.synthesized ? opt.synthesized : opt.files.size();
+    const size_t numJobs = (numSessions + SESSIONS_PER_JOB - 1) / SESSIONS_PER_JOB;
+    std::vector<std::string> rows(numSessions);
+    std::atomic<size_t> samples(0), mismatches(0), failed(0);
+
+    auto start = std::chrono::steady_clock::now();
+    runBatch(numJobs, opt.threads, [&](size_t job) {
+        size_t first = job * SESSIONS_PER_JOB;
+        size_t count = std::min(SESSIONS_PER_JOB, numSessions - first);
+        std::vector<Session> group(count);
+        for (size_t s = 0; s < count; s++) {
+            load(group[s], opt, first + s);
+            failed += !group[s].ok;
+            samples += group[s].samples();
+        }
+
+        std::vector<std::vector<Result> > results;
+        analyze(group, opt, results);
+
+        for (size_t s = 0; s < count; s++) {
+            if (!group[s].ok)
+                continue;
+            std::string& row = rows[first + s];
+            for (size_t k = 0; k < opt.thresholds.size(); k++) {
+                char line[256];
+                snprintf(line, sizeof(line), "%s,%lu,%d,%u,%u,%u,%u\n", group[s].name.c_str(),
+                         (unsigned long)group[s].samples(), opt.thresholds[k],
+                         results[s][k].touchSamples, results[s][k].touchOnsets,
+                         group[s].simplePresses, group[s].softwarePresses);
+                row += line;
+            }
+            if (opt.verify)
+                mismatches += verify(group[s], opt);
+        }
+    });
+    auto stop = std::chrono::steady_clock::now();
+
+    printf("session,samples,threshold,touch_samples,touch_onsets,simple_presses,software_presses\n");
+    for (size_t i = 0; i < rows.size(); i++)
+        fputs(rows[i].c_str(), stdout);
+
+    double wall = std::chrono::duration<double>(stop - start).count();
+    fprintf(stderr, "%lu sessions, %lu samples x %lu thresholds in %.2f s (%.1f M samples/s), %s, %u threads\n",
+            (unsigned long)numSessions, (unsigned long)samples.load(),
+            (unsigned long)opt.thresholds.size(), wall, samples.load() / wall / 1e6,
+            (opt.simd && PadBatch::haveAVX2()) ? "AVX2" : "scalar",
+            opt.threads ? opt.threads : std::thread::hardware_concurrency());
+    if (opt.verify)
+        fprintf(stderr, "verify: %lu samples differ from QuadPressurePad\n", (unsigned long)mismatches.load());
+    return (failed || mismatches) ? 1 : 0;
+}
@@ -72,7 +72,9 @@ class EventTimer {
             if (!running) return; // no-op, unless timer was started with begin()
             currentTime = now;
 
-            if (next - now >= interval) {
+            // strictly greater: at now == next - interval (e.g. the same `now`
+            // that was given to begin()) the timer has only just started
+            if (next - now > interval) {
                 next += interval;
                 expired = true; // THE MOST IMPORTANT THING IN THIS CLASS!
             } else {
@@ -80,6 +82,14 @@ class EventTimer {
             }
         }
 
+        // microseconds until update() will next report expiry; 0 means it's due.
+        // Only meaningful while running.
+        uint32_t timeUntilExpiry(uint32_t now = micros()) const
+        {
+            uint32_t remaining = next - now;
+            return (remaining > interval) ? 0 : remaining + 1;
+        }
+
         inline bool hasExpired(void) const { return expired; }
         inline bool isRunning(void) const { return running; }
 
@@ -0,0 +1,637 @@
+//
+// DisplayMirror.h
+// GSR_Display's drawing, sent over a serial link so a PC can show the same screen
+
+// use cases:
+//   1) watching the device screen live on the PC (host/DisplayMirrorDecoder.h)
+//   2) recording exactly what the experimenter saw, alongside the data
+
+// usage:
+//   DisplayMirror mirror(Serial);
+//   display.mirrorTo(&mirror);
+//   ...
+//   loop() { ...draw...; mirror.endFrame(); }   // once per screen update
+//   if (Serial.read() == DisplayMirror::REDRAW_REQUEST) mirror.redraw();
+
+// what gets sent:
+//   GSR_Display records every TFT call (fillScreen, drawFastHLine,
+//   drawFastVLine, drawPixel, and text with its rotation and cursor) in TFT
+//   coordinates, rotation 0.  endFrame() sends what was recorded since the
+//   last endFrame() as one frame:
+//     0xA5  length (varint)  payload  checksum (sum of payload bytes)
+//   payload: one byte KEY << 7 | sequence (mod 128), then one command after
+//   another:
+//     header   kind << 5 | flags              (flags: X Y LEN COLOR PARTIAL)
+//     x, y, len   zigzag varint delta from the last command of the same kind,
+//                 present only if its flag is set (otherwise unchanged)
+//     color    2 bytes, little-endian, only if COLOR is set
+//     RUN      header, then a varint n: repeat the previous command n times,
+//              applying the same deltas each time
+//     TEXT     header, rotation, x, y (zigzag varint), n (varint), n chars;
+//              drawn in the default text color, white, size 1
+//     PARTIAL  FILL only: this fill starts a redraw() that is missing
+//              something (see below)
+//   The "last command" state carries over from frame to frame, except that
+//   a key frame starts it from zero: every KEY_INTERVAL-th frame, and every
+//   frame that starts with fillScreen.
+//
+// recovering:
+//   A decoder that loses a frame skips the frames after it until the next
+//   key frame, and from there draws on top of a screen with something
+//   missing.  Only a key frame that starts with fillScreen puts it right, so
+//   the host asks for one by sending REDRAW_REQUEST (a decoder attaching
+//   mid-session does the same).  The sketch answers with redraw(), which
+//   sends the whole screen again and leaves the TFT alone.
+//
+//   For that the mirror keeps what was drawn since the last fillScreen, less
+//   whatever was drawn over since: a line or pixel drops what it covers (one
+//   line, or a row of lines, as when the status bar is cleared); a line or
+//   pixel in the fill color over nothing else isn't kept.  A chart keeps one
+//   pixel per point plotted, plus the axes and the two lines of text.  If
+//   more than MAX_RETAINED commands or MAX_RETAINED_TEXT characters are
+//   left, or nothing was filled yet, redraw() can't rebuild the screen
+//   exactly: it sends what it has, with PARTIAL set, and the decoder keeps
+//   asking.  A fillScreen makes it exact again.
+
+// coalescing, within a frame:
+//   fillScreen discards everything recorded before it; a line discards
+//   earlier pixels and shorter lines it covers; a pixel discards an earlier
+//   pixel at the same place.  A chart update (clear a column, plot one
+//   point) is about 5 bytes plus 4 bytes of frame.
+
+// notes:
+//   1) nothing is allocated: MAX_COMMANDS commands and MAX_TEXT characters
+//      per frame; running out sends the frame early.  What redraw() keeps
+//      takes 6 bytes per command, DISPLAY_MIRROR_RETAINED of them (define
+//      it before including this to change it)
+//   2) endFrame() writes the whole frame to the port; at 115200 baud a
+//      typical frame takes about 1 ms
+
+#ifndef __DISPLAY_MIRROR_H__
+#define __DISPLAY_MIRROR_H__
+
+#include "Arduino.h"
+
+#ifndef DISPLAY_MIRROR_RETAINED
+#if defined(__AVR__)
+#define DISPLAY_MIRROR_RETAINED 48
+#else
+#define DISPLAY_MIRROR_RETAINED 384 // two chart traces
+#endif
+#endif
+
+class DisplayMirror {
+
+    public:
+
+        static const uint8_t MAX_COMMANDS{32};
+        static const uint8_t MAX_TEXT{64};
+        static const uint16_t MAX_RETAINED{DISPLAY_MIRROR_RETAINED};
+        static const uint8_t MAX_RETAINED_TEXT{64};
+
+        static const uint8_t SYNC{0xA5};
+        static const uint8_t KEY{0x80};
+        static const uint8_t KEY_INTERVAL{32}; // frames; divides 128
+        static const uint8_t REDRAW_REQUEST{0x5A}; // host to device
+
+        // command kinds (high 3 bits of the header)
+        enum Kind : uint8_t { FILL, HLINE, VLINE, PIXEL, TEXT, RUN, NUM_KINDS };
+
+        // header flags: which fields follow
+        static const uint8_t F_X{1};
+        static const uint8_t F_Y{2};
+        static const uint8_t F_LEN{4};
+        static const uint8_t F_COLOR{8};
+        static const uint8_t F_PARTIAL{16}; // FILL only
+
+        explicit DisplayMirror(Print& port) : out(port)
+        {
+            numCommands = 0;
+            textUsed = 0;
+            frames = 0;
+            bytes = 0;
+            recorded = 0;
+            coalesced = 0;
+            sequence = 0;
+            numRetained = 0;
+            retainedTextUsed = 0;
+            fillColor = 0;
+            partial = true; // nothing known before the first fill
+        }
+
+        virtual ~DisplayMirror() {}
+
+        // what GSR_Display calls, with the same arguments it gives the TFT.
+        // Virtual so that a sketch that never makes a DisplayMirror doesn't
+        // link any of it.
+        virtual void fill(uint16_t color)
+        {
+            coalesced += numCommands;
+            numCommands = 0;
+            textUsed = 0;
+            record(FILL, 0, 0, 0, 0, color);
+            numRetained = 0;
+            retainedTextUsed = 0;
+            fillColor = color;
+            partial = false;
+        }
+
+        virtual void hline(int16_t x, int16_t y, int16_t w, uint16_t color)
+        {
+            cover(x, y, w, 1);
+            record(HLINE, 0, x, y, w, color);
+            retainDrawing(HLINE, x, y, w, 1, color);
+        }
+
+        virtual void vline(int16_t x, int16_t y, int16_t h, uint16_t color)
+        {
+            cover(x, y, 1, h);
+            record(VLINE, 0, x, y, h, color);
+            retainDrawing(VLINE, x, y, 1, h, color);
+        }
+
+        virtual void pixel(int16_t x, int16_t y, uint16_t color)
+        {
+            cover(x, y, 1, 1);
+            record(PIXEL, 0, x, y, 0, color);
+            retainDrawing(PIXEL, x, y, 1, 1, color);
+        }
+
+        virtual void text(uint8_t rotation, int16_t x, int16_t y, const char* s)
+        {
+            uint16_t n = strlen(s);
+            if (n > MAX_TEXT)
+                n = MAX_TEXT;
+            recordText(rotation, x, y, s, n);
+            retainText(rotation, x, y, s, strlen(s));
+        }
+
+        // Send the whole screen again, as one or more frames starting with a
+        // fill; see "recovering" above.  The TFT is not touched.
+        void redraw(void)
+        {
+            coalesced += numCommands;
+            numCommands = 0;
+            textUsed = 0;
+            record(FILL, partial ? 1 : 0, 0, 0, 0, fillColor);
+            for (uint16_t i = 0; i < numRetained; i++) {
+                const Retained& r = retained[i];
+                if (r.kind == TEXT)
+                    recordText(r.rotation, r.x, r.y, &retainedText[r.color], r.len);
+                else
+                    record(r.kind, 0, r.x, r.y, r.kind == VLINE || r.kind == HLINE ? r.len : 0, r.color);
+            }
+            endFrame();
+        }
+
+        // false if redraw() would be missing something
+        inline bool canRedraw(void) const { return !partial; }
+
+        // Send everything recorded since the last endFrame() as one frame.
+        // Nothing is sent if nothing was drawn.
+        void endFrame(void)
+        {
+            if (numCommands == 0)
+                return;
+            uint16_t n = encode(0);
+            out.write(SYNC);
+            bytes += 1 + putVarint(n, &out);
+            encode(&out);
+            out.write(checksum);
+            bytes += n + 1;
+            frames++;
+            sequence = (sequence + 1) & 0x7F;
+            numCommands = 0;
+            textUsed = 0;
+        }
+
+        // instrumentation
+        inline uint32_t framesSent(void) const { return frames; }
+        inline uint32_t bytesSent(void) const { return bytes; }
+        inline uint32_t commandsRecorded(void) const { return recorded; }
+        inline uint32_t commandsCoalesced(void) const { return coalesced; } // never sent
+        void resetStats(void)
+        {
+            frames = 0;
+            bytes = 0;
+            recorded = 0;
+            coalesced = 0;
+        }
+
+    private:
+
+        struct Command {
+            uint8_t kind;
+            uint8_t rotation; // TEXT only
+            int16_t x;
+            int16_t y;
+            int16_t len;      // TEXT: characters
+            uint16_t color;   // TEXT: offset in textBuffer
+        };
+
+        void recordText(uint8_t rotation, int16_t x, int16_t y, const char* s, uint16_t n)
+        {
+            if (numCommands == MAX_COMMANDS || textUsed + n > MAX_TEXT)
+                endFrame();
+            memcpy(&textBuffer[textUsed], s, n);
+            record(TEXT, rotation, x, y, n, textUsed);
+            textUsed += n;
+        }
+
+        void record(uint8_t kind, uint8_t rotation, int16_t x, int16_t y, int16_t len, uint16_t color)
+        {
+            if (numCommands == MAX_COMMANDS)
+                endFrame();
+            Command& c = commands[numCommands++];
+            c.kind = kind;
+            c.rotation = rotation;
+            c.x = x;
+            c.y = y;
+            c.len = len;
+            c.color = color;
+            recorded++;
+        }
+
+        // Forget earlier pixels and lines that the rectangle (x, y, w, h),
+        // about to be drawn, paints over completely.
+        void cover(int16_t x, int16_t y, int16_t w, int16_t h)
+        {
+            uint8_t kept = 0;
+            for (uint8_t i = 0; i < numCommands; i++) {
+                const Command& c = commands[i];
+                int16_t cw = (c.kind == HLINE) ? c.len : 1;
+                int16_t ch = (c.kind == VLINE) ? c.len : 1;
+                bool covered = (c.kind == HLINE || c.kind == VLINE || c.kind == PIXEL) &&
+                               c.x >= x && c.x + cw <= x + w &&
+                               c.y >= y && c.y + ch <= y + h;
+                if (covered)
+                    coalesced++;
+                else
+                    commands[kept++] = c;
+            }
+            numCommands = kept;
+        }
+
+        // Write the payload to `to` (0: just count it).  Return its length.
+        uint16_t encode(Print* to)
+        {
+            sink = to;
+            length = 0;
+            checksum = 0;
+
+            // last value of each field, per kind; kept only when sent
+            bool key = sequence % KEY_INTERVAL == 0 || commands[0].kind == FILL;
+            int16_t last[TEXT][3];
+            uint16_t lastColor[TEXT];
+            if (key) {
+                memset(last, 0, sizeof(last));
+                memset(lastColor, 0, sizeof(lastColor));
+            } else {
+                memcpy(last, sentLast, sizeof(last));
+                memcpy(lastColor, sentColor, sizeof(lastColor));
+            }
+            put((key ? KEY : 0) | sequence);
+            // the previous command, for runs
+            uint8_t prevKind = NUM_KINDS;
+            int32_t prevDelta[3] = {0, 0, 0};
+            uint16_t run = 0;
+
+            for (uint8_t i = 0; i < numCommands; i++) {
+                const Command& c = commands[i];
+                if (c.kind == TEXT) {
+                    putRun(run);
+                    put(TEXT << 5);
+                    put(c.rotation);
+                    putField(c.x);
+                    putField(c.y);
+                    putVarint(c.len, 0);
+                    for (int16_t k = 0; k < c.len; k++)
+                        put(textBuffer[c.color + k]);
+                    prevKind = NUM_KINDS;
+                    continue;
+                }
+
+                int16_t* l = last[c.kind];
+                int32_t delta[3] = {(int32_t)c.x - l[0], (int32_t)c.y - l[1], (int32_t)c.len - l[2]};
+                bool sameColor = c.color == lastColor[c.kind];
+                l[0] = c.x;
+                l[1] = c.y;
+                l[2] = c.len;
+                lastColor[c.kind] = c.color;
+
+                if (c.kind == prevKind && c.kind != FILL && sameColor &&
+                    delta[0] == prevDelta[0] && delta[1] == prevDelta[1] && delta[2] == prevDelta[2]) {
+                    run++;
+                    continue;
+                }
+                putRun(run);
+
+                uint8_t flags = (delta[0] ? F_X : 0) | (delta[1] ? F_Y : 0) |
+                                (delta[2] ? F_LEN : 0) | (sameColor ? 0 : F_COLOR) |
+                                (c.kind == FILL && c.rotation ? F_PARTIAL : 0);
+                put(c.kind << 5 | flags);
+                for (uint8_t k = 0; k < 3; k++)
+                    if (delta[k])
+                        putField(delta[k]);
+                if (!sameColor) {
+                    put(c.color & 0xFF);
+                    put(c.color >> 8);
+                }
+                prevKind = c.kind;
+                for (uint8_t k = 0; k < 3; k++)
+                    prevDelta[k] = delta[k];
+            }
+            putRun(run);
+            if (to) {
+                memcpy(sentLast, last, sizeof(last));
+                memcpy(sentColor, lastColor, sizeof(lastColor));
+            }
+            return length;
+        }
+
+        void putRun(uint16_t& run)
+        {
+            if (run == 0)
+                return;
+            put(RUN << 5);
+            putVarint(run, 0);
+            run = 0;
+        }
+
+        // the byte sinks for encode(): count, sum and maybe write
+        void put(uint8_t b)
+        {
+            length++;
+            checksum += b;
+            if (sink)
+                sink->write(b);
+        }
+
+        void putField(int32_t delta)
+        {
+            uint32_t zigzag = (delta < 0) ? ((uint32_t)(-(delta + 1)) << 1) | 1 : (uint32_t)delta << 1;
+            putVarint(zigzag, 0);
+        }
+
+        // 7 bits per byte, low first.  Writes through put() if to == 0.
+        uint8_t putVarint(uint32_t v, Print* to)
+        {
+            uint8_t n = 0;
+            do {
+                uint8_t b = v & 0x7F;
+                v >>= 7;
+                if (v)
+                    b |= 0x80;
+                if (to)
+                    to->write(b);
+                else
+                    put(b);
+                n++;
+            } while (v);
+            return n;
+        }
+
+        // --- what redraw() sends: drawn since the last fill, not drawn over
+
+        // TFT coordinates; lines and pixels are clipped to the screen
+        struct Retained {
+            uint8_t  kind : 4;
+            uint8_t  rotation : 4; // TEXT only
+            uint8_t  x;
+            uint8_t  y;
+            uint8_t  len;   // lines: length; TEXT: characters
+            uint16_t color; // TEXT: offset in retainedText
+        };
+
+        // the smallest rectangle a command can touch, inclusive
+        struct Box {
+            int16_t x0, y0, x1, y1;
+        };
+
+        static const int16_t SCREEN_W{128};
+        static const int16_t SCREEN_H{160};
+
+        static bool inside(const Box& a, const Box& b) // a within b
+        {
+            return a.x0 >= b.x0 && a.x1 <= b.x1 && a.y0 >= b.y0 && a.y1 <= b.y1;
+        }
+
+        static bool overlap(const Box& a, const Box& b)
+        {
+            return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+        }
+
+        Box boxOf(const Retained& r) const
+        {
+            Box b = {0, 0, -1, -1};
+            if (r.kind == TEXT) {
+                textBox(r.rotation, r.x, r.y, &retainedText[r.color], r.len, b);
+                return b;
+            }
+            b.x0 = r.x;
+            b.y0 = r.y;
+            b.x1 = r.x + (r.kind == HLINE ? r.len - 1 : 0);
+            b.y1 = r.y + (r.kind == VLINE ? r.len - 1 : 0);
+            return b;
+        }
+
+        // Where text can put pixels: 6x8 cells from the cursor, and if it
+        // wraps, everything from its first line down.  False if off screen.
+        static bool textBox(uint8_t rotation, int16_t cx, int16_t cy, const char* s, uint16_t n, Box& b)
+        {
+            int16_t w = (rotation & 1) ? SCREEN_H : SCREEN_W;
+            int16_t h = (rotation & 1) ? SCREEN_W : SCREEN_H;
+            Box r = {cx, cy, (int16_t)(cx + 6 * n - 1), (int16_t)(cy + 7)};
+            if (r.x1 >= w || memchr(s, '\n', n)) {
+                r.x0 = 0;
+                r.x1 = w - 1;
+                r.y1 = h - 1;
+            }
+            if (r.x0 < 0) r.x0 = 0;
+            if (r.y0 < 0) r.y0 = 0;
+            if (r.x1 >= w) r.x1 = w - 1;
+            if (r.y1 >= h) r.y1 = h - 1;
+            if (n == 0 || r.x0 > r.x1 || r.y0 > r.y1)
+                return false;
+            // back to rotation 0, as MirrorCanvas maps it
+            switch (rotation & 3) {
+                case 0: b = r; break;
+                case 1: b = {(int16_t)(SCREEN_W - 1 - r.y1), r.x0, (int16_t)(SCREEN_W - 1 - r.y0), r.x1}; break;
+                case 2: b = {(int16_t)(SCREEN_W - 1 - r.x1), (int16_t)(SCREEN_H - 1 - r.y1),
+                             (int16_t)(SCREEN_W - 1 - r.x0), (int16_t)(SCREEN_H - 1 - r.y0)}; break;
+                case 3: b = {r.y0, (int16_t)(SCREEN_H - 1 - r.x1), r.y1, (int16_t)(SCREEN_H - 1 - r.x0)}; break;
+            }
+            return true;
+        }
+
+        // a line or pixel covering (x, y, w, h)
+        void retainDrawing(uint8_t kind, int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color)
+        {
+            Box b = {x, y, (int16_t)(x + w - 1), (int16_t)(y + h - 1)};
+            if (b.x0 < 0) b.x0 = 0;
+            if (b.y0 < 0) b.y0 = 0;
+            if (b.x1 >= SCREEN_W) b.x1 = SCREEN_W - 1;
+            if (b.y1 >= SCREEN_H) b.y1 = SCREEN_H - 1;
+            if (w <= 0 || h <= 0 || b.x0 > b.x1 || b.y0 > b.y1)
+                return; // draws nothing
+
+            // what it paints over completely goes
+            uint16_t kept = 0;
+            bool touches = false;
+            for (uint16_t i = 0; i < numRetained; i++) {
+                Box r = boxOf(retained[i]);
+                if (inside(r, b)) {
+                    dropText(i);
+                    continue;
+                }
+                touches |= overlap(r, b);
+                retained[kept++] = retained[i];
+            }
+            numRetained = kept;
+            // the fill color over nothing else changes nothing
+            if (!touches && color == fillColor)
+                return;
+
+            if (numRetained == MAX_RETAINED) {
+                partial = true;
+                return;
+            }
+            Retained& r = retained[numRetained++];
+            r.kind = kind;
+            r.rotation = 0;
+            r.x = b.x0;
+            r.y = b.y0;
+            r.len = (kind == VLINE) ? b.y1 - b.y0 + 1 : b.x1 - b.x0 + 1;
+            r.color = color;
+
+            // together with the lines before it, it may finish covering
+            // something bigger (the status bar is cleared one line at a time)
+            bool dropped = false;
+            kept = 0;
+            for (uint16_t i = 0; i < numRetained; i++) {
+                if (i < numRetained - 1 && overlap(boxOf(retained[i]), b) && coveredLater(i)) {
+                    dropText(i);
+                    dropped = true;
+                    continue;
+                }
+                retained[kept++] = retained[i];
+            }
+            numRetained = kept;
+            if (dropped)
+                dropRedundant();
+        }
+
+        void retainText(uint8_t rotation, int16_t x, int16_t y, const char* s, uint16_t n)
+        {
+            Box b;
+            if (!textBox(rotation, x, y, s, n, b))
+                return; // off screen
+            if (numRetained == MAX_RETAINED || retainedTextUsed + n > MAX_RETAINED_TEXT ||
+                x < 0 || y < 0 || x > 255 || y > 255) {
+                partial = true;
+                return;
+            }
+            memcpy(&retainedText[retainedTextUsed], s, n);
+            Retained& r = retained[numRetained++];
+            r.kind = TEXT;
+            r.rotation = rotation;
+            r.x = x;
+            r.y = y;
+            r.len = n;
+            r.color = retainedTextUsed;
+            retainedTextUsed += n;
+        }
+
+        // Is every column, or every row, of retained[i] painted over by
+        // a single line or pixel drawn after it?
+        bool coveredLater(uint16_t i) const
+        {
+            Box b = boxOf(retained[i]);
+            bool columns = true;
+            for (int16_t x = b.x0; x <= b.x1 && columns; x++) {
+                Box c = {x, b.y0, x, b.y1};
+                columns = paintedLater(i, c);
+            }
+            if (columns)
+                return true;
+            for (int16_t y = b.y0; y <= b.y1; y++) {
+                Box c = {b.x0, y, b.x1, y};
+                if (!paintedLater(i, c))
+                    return false;
+            }
+            return true;
+        }
+
+        bool paintedLater(uint16_t i, const Box& c) const
+        {
+            for (uint16_t j = i + 1; j < numRetained; j++)
+                if (retained[j].kind != TEXT && inside(c, boxOf(retained[j])))
+                    return true;
+            return false;
+        }
+
+        // Lines and pixels in the fill color that no longer paint over
+        // anything kept before them.
+        void dropRedundant(void)
+        {
+            uint16_t kept = 0;
+            for (uint16_t i = 0; i < numRetained; i++) {
+                const Retained& r = retained[i];
+                if (r.kind != TEXT && r.color == fillColor) {
+                    Box b = boxOf(r);
+                    bool touches = false;
+                    for (uint16_t j = 0; j < kept && !touches; j++)
+                        touches = overlap(boxOf(retained[j]), b);
+                    if (!touches)
+                        continue;
+                }
+                retained[kept++] = r;
+            }
+            numRetained = kept;
+        }
+
+        // retained[i] is about to go: give back its characters
+        void dropText(uint16_t i)
+        {
+            if (retained[i].kind != TEXT)
+                return;
+            uint16_t at = retained[i].color;
+            uint8_t n = retained[i].len;
+            memmove(&retainedText[at], &retainedText[at + n], retainedTextUsed - at - n);
+            retainedTextUsed -= n;
+            for (uint16_t j = 0; j < numRetained; j++)
+                if (retained[j].kind == TEXT && retained[j].color > at)
+                    retained[j].color -= n;
+        }
+
+        Print&   out;
+        Command  commands[MAX_COMMANDS];
+        uint8_t  numCommands;
+        char     textBuffer[MAX_TEXT];
+        uint8_t  textUsed;
+
+        Retained retained[MAX_RETAINED];
+        uint16_t numRetained;
+        char     retainedText[MAX_RETAINED_TEXT];
+        uint8_t  retainedTextUsed;
+        uint16_t fillColor;
+        bool     partial;    // retained is missing something
+
+        // the decoder's "last command" state after the last frame sent
+        int16_t  sentLast[TEXT][3];
+        uint16_t sentColor[TEXT];
+        uint8_t  sequence;
+
+        // encode() state
+        Print*   sink;
+        uint16_t length;
+        uint8_t  checksum;
+
+        uint32_t frames;
+        uint32_t bytes;
+        uint32_t recorded;
+        uint32_t coalesced;
+
+}; // class DisplayMirror
+
+#endif // __DISPLAY_MIRROR_H__
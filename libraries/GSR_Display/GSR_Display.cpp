@@ -10,26 +10,27 @@
 #include "GSR_Display.h"
 
 GSR_Display::GSR_Display(unsigned CS_PIN, unsigned DC_PIN, unsigned RESET_PIN)
+    : TFT(CS_PIN, DC_PIN, RESET_PIN)
 {
-    pTFT = new Adafruit_ST7735(CS_PIN, DC_PIN, RESET_PIN);
+    pTFT = &TFT;
+    mirror = 0;
 }
 
 GSR_Display::~GSR_Display()
 {
-    delete pTFT;
 }
 
 void GSR_Display::begin(unsigned bgcolor)
 {
     BgColor = bgcolor;
     pTFT->initR(INITR_BLACKTAB); // initialize a ST7735R chip (black tab version of chip)
-    pTFT->fillScreen(BgColor);   // clear the screen and set the background
+    fill(BgColor);               // clear the screen and set the background
     pTFT->setRotation(0);
 }
 
 void GSR_Display::clear(void)
 {
-    pTFT->fillScreen(BgColor); // clear the screen and set the background
+    fill(BgColor); // clear the screen and set the background
 }
 
 void GSR_Display::setupChart(void)
@@ -37,44 +38,76 @@ void GSR_Display::setupChart(void)
     clear();
 
     // draw the chart axis
-    pTFT->drawFastHLine(YMin - 1, XMin - 1, YMax + 1, ST7735_WHITE);
-    pTFT->drawFastVLine(YMin - 1, XMin - 1, XMax + 1, ST7735_WHITE);
+    hline(YMin - 1, XMin - 1, YMax + 1, ST7735_WHITE);
+    vline(YMin - 1, XMin - 1, XMax + 1, ST7735_WHITE);
 
     // draw center line
-    pTFT->drawFastVLine((YMax - YMin) / 2 + YMid, 0, XMin - 1, ST7735_WHITE);
+    vline((YMax - YMin) / 2 + YMid, 0, XMin - 1, ST7735_WHITE);
 }
 
-void GSR_Display::say(String message)
+void GSR_Display::say(const char* message)
 {
   for (int i = BarMin - 10; i < BarMin; i++)
-    pTFT->drawFastVLine(i, BarLeft, BarRight, ST7735_BLACK);
-  pTFT->setRotation(1);
-  pTFT->setCursor(10, 13);
-  pTFT->print(message);
-  pTFT->setRotation(0);
+    vline(i, BarLeft, BarRight, ST7735_BLACK);
+  text(10, 13, message);
 }
 
-void GSR_Display::statusBar(String message)
+void GSR_Display::statusBar(const char* message)
 {
   for (int i = BarMin; i < BarMax; i++)
-    pTFT->drawFastVLine(i, BarLeft, BarRight, ST7735_BLACK);
-  pTFT->setRotation(1);
-  pTFT->setCursor(10, 3);
-  pTFT->print(message);
-  pTFT->setRotation(0);
+    vline(i, BarLeft, BarRight, ST7735_BLACK);
+  text(10, 3, message);
 }
 
 void GSR_Display::drawPixel(unsigned x, unsigned y, unsigned color)
 {
-    pTFT->drawPixel(y + YMin, x + XMin, color);
+    pixel(y + YMin, x + XMin, color);
 }
 
 void GSR_Display::clearColumn(unsigned x)
 {
-    pTFT->drawFastHLine(YMin, x + XMin, YMax, BgColor);
+    hline(YMin, x + XMin, YMax, BgColor);
 }
 
 void GSR_Display::updatePosBar(unsigned x)
 {
-    pTFT->drawFastHLine(YMin, x + XMin, YMax, BgColor);
+    hline(YMin, x + XMin, YMax, BgColor);
+}
+
+void GSR_Display::fill(unsigned color)
+{
+    pTFT->fillScreen(color);
+    if (mirror)
+        mirror->fill(color);
+}
+
+void GSR_Display::hline(int x, int y, int w, unsigned color)
+{
+    pTFT->drawFastHLine(x, y, w, color);
+    if (mirror)
+        mirror->hline(x, y, w, color);
+}
+
+void GSR_Display::vline(int x, int y, int h, unsigned color)
+{
+    pTFT->drawFastVLine(x, y, h, color);
+    if (mirror)
+        mirror->vline(x, y, h, color);
+}
+
+void GSR_Display::pixel(int x, int y, unsigned color)
+{
+    pTFT->drawPixel(x, y, color);
+    if (mirror)
+        mirror->pixel(x, y, color);
+}
+
+void GSR_Display::text(int x, int y, const char* message)
+{
+    pTFT->setRotation(1);
+    pTFT->setCursor(x, y);
+    pTFT->print(message);
+    pTFT->setRotation(0);
+    if (mirror)
+        mirror->text(1, x, y, message);
 }
@@ -13,6 +13,10 @@
 #include <Adafruit_GFX.h>
 #include <Adafruit_ST7735.h>
 #include <SPI.h>
+#include "DisplayMirror.h"
+
+// Build with -DPBS_STATIC_MEMORY to leave out everything that uses the heap
+// (the String overloads); the display itself never allocates.
 
 class GSR_Display {
   public:
@@ -20,8 +24,12 @@ class GSR_Display {
     ~GSR_Display();
 
     // text displayed up top
-    void say(String message);
-    void statusBar(String message);
+    void say(const char* message);
+    void statusBar(const char* message);
+#ifndef PBS_STATIC_MEMORY
+    void say(const String& message) { say(message.c_str()); }
+    void statusBar(const String& message) { statusBar(message.c_str()); }
+#endif
 
     void begin(unsigned bgcolor);
     void clear(void);
@@ -40,9 +48,14 @@ class GSR_Display {
     void clearColumn(unsigned x);
     void updatePosBar(unsigned x);
 
+    // also send every drawing operation to `m` (0: stop); see DisplayMirror.h
+    void mirrorTo(DisplayMirror* m) { mirror = m; }
+
   protected:
-    Adafruit_ST7735  *pTFT;
+    Adafruit_ST7735  TFT;   // held by value: no heap
+    Adafruit_ST7735  *pTFT; // == &TFT, for existing subclasses
     unsigned         BgColor;
+    DisplayMirror    *mirror; // 0 unless mirroring
 
   private:
     // for the chart:
@@ -51,6 +64,13 @@ class GSR_Display {
     const static uint8_t YMid  {  7};
     const static uint8_t Width {140};
     const static uint8_t Height{ 90};
+
+    // the TFT calls, also recorded for the mirror
+    void fill(unsigned color);
+    void hline(int x, int y, int w, unsigned color);
+    void vline(int x, int y, int h, unsigned color);
+    void pixel(int x, int y, unsigned color);
+    void text(int x, int y, const char* message); // rotation 1
 };
 #endif // __DISPLAY_H__
 
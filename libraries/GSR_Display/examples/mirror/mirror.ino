@@ -0,0 +1,54 @@
+//
+// Example usage of DisplayMirror
+// Plots a GSR channel at 16 Hz with the reading in the status bar, and sends
+// the screen to the PC over Serial: run examples/mirror_render on the PC
+// side to see it.  Nothing else may print to Serial while mirroring, except
+// short lines of text, which the renderer skips.  When the PC lost a frame
+// or attached late, it sends a REDRAW_REQUEST and gets the whole screen.
+
+#include "GSR_Display.h"
+#include "DisplayMirror.h"
+#include "EventTimer.h"
+
+const uint8_t gsrPin{A0};
+GSR_Display display(10, 9, 8);
+DisplayMirror mirror(Serial);
+EventTimer sampleTimer(62500); // 16 Hz
+EventTimer frameTimer(33333);  // ~30 screen updates/s
+unsigned column{0};
+uint8_t samples{0};
+
+void setup() {
+    Serial.begin(115200);
+    display.mirrorTo(&mirror);
+    display.begin(ST7735_BLACK);
+    display.setupChart();
+    mirror.endFrame();
+    sampleTimer.begin();
+    frameTimer.begin();
+}
+
+void loop() {
+    while (Serial.available())
+        if (Serial.read() == DisplayMirror::REDRAW_REQUEST)
+            mirror.redraw();
+
+    sampleTimer.update();
+    if (sampleTimer.hasExpired()) {
+        int reading = analogRead(gsrPin);
+        display.clearColumn(column);
+        display.drawPixel(column, (long)reading * GSR_Display::YMax / 1024);
+        column = (column + 1) % GSR_Display::XMax;
+        if (++samples == 16) {
+            char text[16];
+            snprintf(text, sizeof(text), "%d mV", (int)(reading * 3300L / 1024));
+            display.statusBar(text);
+            samples = 0;
+        }
+    }
+
+    // everything drawn since the last update goes out as one frame
+    frameTimer.update();
+    if (frameTimer.hasExpired())
+        mirror.endFrame();
+}
@@ -0,0 +1,271 @@
+//
+// mirror_bench.cpp (host)
+// Link cost of mirroring GSR_Display, at typical GSR sample rates.
+//
+// build: see ../../README.md
+//
+// run:
+//   ./mirror_bench                  # 60 s at 4, 8, 16, 32 and 64 Hz
+//   ./mirror_bench -s 600 -f 20 10  # 10 minutes at 10 Hz, 20 screen updates/s
+//   ./mirror_bench -o capture.bin 16  # also save the stream, for mirror_render
+//
+// The real GSR_Display (on the host TFT stand-in) runs a typical session:
+// setupChart(), then for every GSR sample one chart column (clearColumn() +
+// drawPixel()), and the reading in the status bar once a second.  The mirror
+// sends one frame per screen update (-f, default 30/s).  Everything sent is
+// decoded again, and the rebuilt screen is compared with the stand-in's
+// after every frame.
+//
+// Printed per sample rate:
+//   bytes/update  mirror bytes per chart update, status text included
+//   bytes/s       link use; 115200 baud carries ~11520
+//   unpacked/s    the same commands as plain 9-byte records, no coalescing
+//   full/s        sending the 40960-byte framebuffer every screen update
+//   match         whether the rebuilt screen always equalled the TFT
+//
+// Then, at the first sample rate, the two ways the PC can end up with the
+// wrong screen: a frame lost three quarters of the way through, and
+// attaching there, with one, two and three points plotted per column.  The bench
+// plays the PC: when the decoder needsRedraw(), it sends a REDRAW_REQUEST,
+// which the device sees one screen update later and answers with
+// mirror.redraw().  Printed: the requests sent, how many screen updates
+// after the fault the screen matched again, the bytes the redraws cost,
+// whether it matched from then to the end, whether the redraw was exact,
+// and whether the decoder ever called a screen complete that wasn't
+// ("honest").  A full chart with three points per column is more than the
+// mirror keeps (DISPLAY_MIRROR_RETAINED), so there the redraw is partial:
+// the screen never matches, and the decoder goes on asking.
+
+#include "GSR_Display.h"
+#include "DisplayMirrorDecoder.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string>
+
+// remembers every byte, for decoding
+class ByteLog : public Print {
+
+    public:
+
+        size_t write(uint8_t c)
+        {
+            bytes.push_back(c);
+            return 1;
+        }
+        using Print::write;
+
+        std::vector<uint8_t> bytes;
+
+}; // class ByteLog
+
+// GSR_Display with its TFT in view
+class BenchDisplay : public GSR_Display {
+
+    public:
+
+        BenchDisplay() : GSR_Display(10, 9, 8) {}
+        const MirrorCanvas& screen(void) const { return TFT.screen; }
+
+}; // class BenchDisplay
+
+enum Fault { NO_FAULT, LOSE_FRAME, ATTACH_LATE };
+
+struct Result {
+    uint32_t updates = 0;  // chart columns drawn
+    uint32_t frames = 0;   // screen updates with something to send
+    uint64_t bytes = 0;    // mirror bytes after setupChart()
+    uint64_t unpacked = 0; // 9 bytes per recorded command (+ text) after setupChart()
+    bool match = true;     // with a fault: from `matched` on
+    uint32_t fault = 0;    // screen update the fault hit
+    uint32_t matched = 0;  // screen update the screen matched again at
+    uint32_t requests = 0; // REDRAW_REQUESTs sent
+    uint32_t redrawBytes = 0;
+    bool honest = true;    // needsRedraw() whenever the screen differed
+    bool partial = false;  // a redraw() couldn't send everything
+};
+
+// A skin conductance trace: slow drift, a response every ~20 s.
+static double gsr(double t)
+{
+    double level = 0.5 + 0.2 * sin(t / 40.0);
+    double phase = fmod(t, 20.0);
+    level += 0.25 * (phase / 1.5) * exp(1 - phase / 1.5);
+    return level;
+}
+
+// `traces` points per column, each its own color.  With a fault, the first
+// frame sent from screen update `faultAt` on is lost, or is the first the
+// decoder sees.
+static Result run(double seconds, uint32_t sampleRate, uint32_t frameRate, FILE* save,
+                  unsigned traces = 1, Fault fault = NO_FAULT, uint32_t faultAt = 0)
+{
+    static const unsigned colors[3] = {ST7735_WHITE, ST7735_GREEN, ST7735_YELLOW};
+    static BenchDisplay display; // as a sketch would have it: a global
+    ByteLog link;
+    DisplayMirror mirror(link);
+    MirrorCanvas rebuilt;
+    DisplayMirrorDecoder decoder(rebuilt);
+    Result r;
+
+    display.mirrorTo(&mirror);
+    display.begin(ST7735_BLACK);
+    display.setupChart();
+    mirror.endFrame();
+    decoder.feed(link.bytes.data(), link.bytes.size());
+    if (save)
+        fwrite(link.bytes.data(), 1, link.bytes.size(), save);
+    link.bytes.clear();
+    uint32_t setupBytes = mirror.bytesSent();
+    uint32_t setupCommands = mirror.commandsRecorded();
+    mirror.resetStats();
+
+    uint64_t textBytes = 0;
+    unsigned column = 0;
+    uint32_t sample = 0;
+    uint32_t frames = seconds * frameRate;
+    bool requested = false; // a REDRAW_REQUEST is on its way to the device
+    uint32_t requestedAt = 0;
+    for (uint32_t f = 1; f <= frames; f++) {
+        if (requested) {
+            uint32_t before = mirror.bytesSent();
+            r.partial |= !mirror.canRedraw();
+            mirror.redraw();
+            r.redrawBytes += mirror.bytesSent() - before;
+            requested = false;
+        }
+
+        // the samples that arrived since the last screen update
+        for (; (uint64_t)sample * frameRate < (uint64_t)f * sampleRate; sample++) {
+            double t = (double)sample / sampleRate;
+            display.clearColumn(column);
+            for (unsigned k = 0; k < traces; k++) {
+                // the others: the same trace, faster
+                unsigned y = gsr(t * (1 + 2 * k)) * (GSR_Display::YMax - 1);
+                display.drawPixel(column, y, colors[k]);
+            }
+            column = (column + 1) % GSR_Display::XMax;
+            r.updates++;
+            if (sample % sampleRate == 0) {
+                char text[24];
+                snprintf(text, sizeof(text), "GSR %d.%02d uS", (int)(gsr(t) * 10), (int)(gsr(t) * 1000) % 100);
+                display.statusBar(text);
+                textBytes += strlen(text);
+            }
+        }
+        mirror.endFrame();
+
+        bool lost = f < faultAt ? fault == ATTACH_LATE
+                                : fault == LOSE_FRAME && !r.fault && !link.bytes.empty();
+        if (fault != NO_FAULT && !r.fault && f >= faultAt && (lost || fault == ATTACH_LATE))
+            r.fault = f;
+        bool fed = !lost && !link.bytes.empty();
+        if (!lost)
+            decoder.feed(link.bytes.data(), link.bytes.size());
+        if (save)
+            fwrite(link.bytes.data(), 1, link.bytes.size(), save);
+        link.bytes.clear();
+        bool same = rebuilt == display.screen();
+        // a decoder can't know of a lost frame before the next one arrives
+        if (fed)
+            r.honest &= same || decoder.needsRedraw();
+        if (fault == NO_FAULT)
+            r.match &= same;
+        else if (r.matched)
+            r.match &= same && !decoder.needsRedraw();
+        else if (r.fault && f > r.fault && same && !decoder.needsRedraw())
+            r.matched = f;
+
+        // the PC's side: ask again if a second goes by unanswered
+        if (!lost && decoder.needsRedraw() && (requestedAt == 0 || f - requestedAt >= frameRate)) {
+            requested = true;
+            requestedAt = f;
+            r.requests++;
+        }
+    }
+
+    r.frames = mirror.framesSent();
+    r.bytes = mirror.bytesSent();
+    r.unpacked = 9ull * mirror.commandsRecorded() + textBytes;
+    r.match &= decoder.badFrames() == 0 && decoder.skippedBytes() == 0;
+    if (fault != NO_FAULT)
+        r.match &= r.matched != 0;
+    display.mirrorTo(0);
+
+    static bool once = false;
+    if (!once) {
+        printf("setupChart(): %u commands, %u bytes\n\n", setupCommands, setupBytes);
+        once = true;
+    }
+    return r;
+}
+
+int main(int argc, char** argv)
+{
+    double seconds = 60;
+    uint32_t frameRate = 30;
+    std::vector<uint32_t> rates;
+    FILE* save = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string a = argv[i];
+        if (a == "-s" && i + 1 < argc)
+            seconds = atof(argv[++i]);
+        else if (a == "-f" && i + 1 < argc)
+            frameRate = strtoul(argv[++i], 0, 10);
+        else if (a == "-o" && i + 1 < argc && !save) {
+            if (!(save = fopen(argv[++i], "wb"))) {
+                fprintf(stderr, "%s: can't write\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (a[0] != '-')
+            rates.push_back(strtoul(argv[i], 0, 10));
+        else {
+            fprintf(stderr, "usage: %s [-s seconds] [-f frames/s] [-o capture.bin] [sample rate ...]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (rates.empty())
+        rates = {4, 8, 16, 32, 64};
+    if (seconds <= 0 || frameRate == 0)
+        return 2;
+
+    bool ok = true;
+    printf("%.0f s, %u screen updates/s\n", seconds, frameRate);
+    for (size_t i = 0; i < rates.size(); i++) {
+        // only the first rate is saved: one session per capture
+        Result r = run(seconds, rates[i], frameRate, i == 0 ? save : 0);
+        if (i == 0) {
+            printf("%8s %8s %13s %9s %11s %10s %6s\n",
+                   "rate/Hz", "frames", "bytes/update", "bytes/s", "unpacked/s", "full/s", "match");
+        }
+        printf("%8u %8u %13.2f %9.1f %11.1f %10.0f %6s\n", rates[i], r.frames,
+               (double)r.bytes / r.updates, r.bytes / seconds, r.unpacked / seconds,
+               40960.0 * r.frames / seconds, r.match ? "yes" : "NO");
+        ok &= r.match;
+    }
+
+    // recovering, three quarters of the way through
+    uint32_t when = seconds * frameRate * 3 / 4;
+    const char* names[] = {"lost frame", "late attach"};
+    Fault faults[] = {LOSE_FRAME, ATTACH_LATE};
+    printf("\nat %u Hz, screen update %u:\n", rates[0], when);
+    printf("%7s %12s %9s %14s %13s %6s %8s %7s\n",
+           "points", "fault", "requests", "updates later", "redraw/bytes", "match", "redraw", "honest");
+    for (unsigned traces = 1; traces <= 3; traces++) {
+        for (int i = 0; i < 2; i++) {
+            Result r = run(seconds, rates[0], frameRate, 0, traces, faults[i], when);
+            char later[16] = "never";
+            if (r.matched)
+                snprintf(later, sizeof(later), "%u", r.matched - r.fault);
+            printf("%7u %12s %9u %14s %13u %6s %8s %7s\n", traces, names[i], r.requests, later,
+                   r.redrawBytes, r.match ? "yes" : "no", r.partial ? "partial" : "exact",
+                   r.honest ? "yes" : "NO");
+            // one or two traces always fit
+            ok &= r.honest && (r.partial ? traces > 2 && !r.matched : r.match);
+        }
+    }
+    if (save)
+        fclose(save);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,82 @@
+//
+// mirror_render.cpp (host)
+// Rebuilds the device screen from a DisplayMirror capture.
+//
+// build: see ../../README.md
+//
+// run:
+//   ./mirror_render capture.bin screen.ppm          # a saved capture
+//   ./mirror_render /dev/ttyACM0 screen.ppm         # live; the picture is
+//                                                    # rewritten every 30 frames
+//   cat /dev/ttyACM0 | ./mirror_render - screen.ppm  # live, read-only
+//
+// Prints every piece of text the device drew, and at the end how many frames
+// were drawn, damaged, or lost waiting for a key frame.  Other serial output
+// mixed into the stream is skipped.
+//
+// Reading a serial port directly (set it up with stty first), it asks the
+// device for a redraw whenever the picture may be incomplete: on attaching,
+// and after a lost or damaged frame.  At most once a second.  A capture
+// can't be asked, so there the picture is only complete from the first
+// fillScreen on, and after a loss it stays incomplete until the next one.
+
+#include "DisplayMirrorDecoder.h"
+
+#include <string.h>
+#include <sys/stat.h>
+#include <time.h>
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        fprintf(stderr, "usage: %s (capture.bin | -) screen.ppm\n", argv[0]);
+        return 2;
+    }
+    FILE* in = strcmp(argv[1], "-") ? fopen(argv[1], "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "%s: can't read\n", argv[1]);
+        return 1;
+    }
+
+    // a serial port: also the way back to the device
+    struct stat st;
+    FILE* back = 0;
+    if (in != stdin && fstat(fileno(in), &st) == 0 && S_ISCHR(st.st_mode)) {
+        back = fopen(argv[1], "wb");
+        setvbuf(in, 0, _IONBF, 0);
+    }
+
+    static MirrorCanvas screen;
+    DisplayMirrorDecoder decoder(screen);
+    decoder.onText([](uint8_t rotation, int16_t x, int16_t y, const std::string& text) {
+        printf("text r%u (%d,%d): %s\n", rotation, x, y, text.c_str());
+        fflush(stdout);
+    });
+
+    uint8_t buf[256];
+    size_t n;
+    size_t written = 0;
+    time_t requested = 0;
+    while ((n = fread(buf, 1, (in == stdin || back) ? 1 : sizeof(buf), in)) > 0) {
+        decoder.feed(buf, n);
+        if (back && decoder.needsRedraw() && time(0) > requested) {
+            fputc(DisplayMirror::REDRAW_REQUEST, back);
+            fflush(back);
+            requested = time(0);
+        }
+        if (decoder.frames() >= written + 30) {
+            screen.writePPM(argv[2]);
+            written = decoder.frames();
+        }
+    }
+    if (back)
+        fclose(back);
+    if (!screen.writePPM(argv[2])) {
+        fprintf(stderr, "%s: can't write\n", argv[2]);
+        return 1;
+    }
+    fprintf(stderr, "%lu frames drawn, %lu damaged, %lu lost, %lu other bytes\n",
+            (unsigned long)decoder.frames(), (unsigned long)decoder.badFrames(),
+            (unsigned long)decoder.lostFrames(), (unsigned long)decoder.skippedBytes());
+    return 0;
+}
@@ -0,0 +1,10 @@
+//
+// Adafruit_GFX.h (host)
+// Nothing to declare: the host Adafruit_ST7735.h stand-in is self-contained.
+
+#ifndef __HOST_ADAFRUIT_GFX_H__
+#define __HOST_ADAFRUIT_GFX_H__
+
+#include "Arduino.h"
+
+#endif // __HOST_ADAFRUIT_GFX_H__
@@ -0,0 +1,72 @@
+//
+// Adafruit_ST7735.h (host)
+// Stand-in for the ST7735 driver: draws into a MirrorCanvas instead of a TFT
+
+// Just the calls GSR_Display makes.  Put this directory ahead of the real
+// Adafruit libraries on the host include path, together with
+// PinTrace/host for Arduino.h and SPI.h.  `screen` is what the TFT would show;
+// it lives on the heap, so misc/footprint doesn't count its 40 KB against
+// GSR_Display.
+
+#ifndef __HOST_ADAFRUIT_ST7735_H__
+#define __HOST_ADAFRUIT_ST7735_H__
+
+#include "Arduino.h"
+#include "MirrorCanvas.h"
+
+#define INITR_BLACKTAB 0x0
+
+#define ST7735_BLACK   0x0000
+#define ST7735_BLUE    0x001F
+#define ST7735_RED     0xF800
+#define ST7735_GREEN   0x07E0
+#define ST7735_CYAN    0x07FF
+#define ST7735_MAGENTA 0xF81F
+#define ST7735_YELLOW  0xFFE0
+#define ST7735_WHITE   0xFFFF
+
+class Adafruit_ST7735 : public Print {
+
+    public:
+
+        Adafruit_ST7735(uint8_t cs, uint8_t rs, uint8_t rst) : screen(*new MirrorCanvas)
+        {
+            (void)cs;
+            (void)rs;
+            (void)rst;
+            rotation = 0;
+            cursorX = 0;
+            cursorY = 0;
+        }
+        ~Adafruit_ST7735() { delete &screen; }
+        Adafruit_ST7735(const Adafruit_ST7735&) = delete;
+        Adafruit_ST7735& operator=(const Adafruit_ST7735&) = delete;
+
+        void initR(uint8_t options) { (void)options; rotation = 0; }
+        void setRotation(uint8_t r) { rotation = r & 3; }
+        void setCursor(int16_t x, int16_t y) { cursorX = x; cursorY = y; }
+
+        // rotation 0 only, which is all GSR_Display uses for drawing
+        void fillScreen(uint16_t color) { screen.fill(color); }
+        void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) { screen.hline(x, y, w, color); }
+        void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) { screen.vline(x, y, h, color); }
+        void drawPixel(int16_t x, int16_t y, uint16_t color) { screen.pixel(x, y, color); }
+
+        size_t write(uint8_t c)
+        {
+            screen.write(rotation, cursorX, cursorY, c);
+            return 1;
+        }
+        using Print::write;
+
+        MirrorCanvas& screen;
+
+    private:
+
+        uint8_t rotation;
+        int16_t cursorX;
+        int16_t cursorY;
+
+}; // class Adafruit_ST7735
+
+#endif // __HOST_ADAFRUIT_ST7735_H__
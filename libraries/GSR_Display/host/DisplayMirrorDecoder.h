@@ -0,0 +1,236 @@
+//
+// DisplayMirrorDecoder.h (host)
+// Rebuilds the device screen from a DisplayMirror byte stream
+
+// usage:
+//   MirrorCanvas screen;
+//   DisplayMirrorDecoder decoder(screen);
+//   while (n = read(port, buf, sizeof(buf))) decoder.feed(buf, n);
+//   screen.writePPM("screen.ppm");
+//   if (decoder.needsRedraw()) ...send DisplayMirror::REDRAW_REQUEST...
+//
+// Bytes can arrive in any pieces; a frame is drawn once all of it is in.
+// Anything that isn't a frame with a good checksum (other serial output,
+// a damaged frame) is skipped and counted, and decoding picks up at the
+// next 0xA5 that starts a good frame.  After a lost or damaged frame,
+// frames are counted as lost until the next key frame.
+//
+// needsRedraw() says whether the screen may differ from the device's: from
+// the start, and after any lost or damaged frame, until a key frame that
+// starts with a fill without PARTIAL set.  Ask the device for one with a
+// REDRAW_REQUEST byte, and give it a moment to answer before asking again.  See DisplayMirror.h
+// for the format.
+
+#ifndef __DISPLAY_MIRROR_DECODER_H__
+#define __DISPLAY_MIRROR_DECODER_H__
+
+#include "MirrorCanvas.h"
+#include "DisplayMirror.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+class DisplayMirrorDecoder {
+
+    public:
+
+        static const size_t MAX_FRAME{4096};
+
+        // called for every TEXT command, after it is drawn
+        typedef std::function<void(uint8_t rotation, int16_t x, int16_t y, const std::string& text)> TextHandler;
+
+        explicit DisplayMirrorDecoder(MirrorCanvas& c) : canvas(c), numFrames(0), numBad(0), numSkipped(0), numLost(0)
+        {
+            synced = false;
+            complete = false;
+            expected = 0;
+        }
+
+        void onText(TextHandler handler) { textHandler = handler; }
+
+        void feed(const uint8_t* data, size_t n)
+        {
+            pending.insert(pending.end(), data, data + n);
+            size_t pos = 0;
+            for (;;) {
+                while (pos < pending.size() && pending[pos] != DisplayMirror::SYNC) {
+                    pos++;
+                    numSkipped++;
+                }
+                if (pos == pending.size())
+                    break;
+
+                // SYNC, length, payload, checksum
+                const uint8_t* p = pending.data() + pos + 1;
+                const uint8_t* end = pending.data() + pending.size();
+                uint32_t length;
+                if (!getVarint(p, end, length)) {
+                    if (end - p >= 5)
+                        goto bad; // not a length at all
+                    break;        // the rest hasn't arrived yet
+                }
+                if (length > MAX_FRAME)
+                    goto bad;
+                if ((size_t)(end - p) < length + 1)
+                    break;
+                {
+                    uint8_t sum = 0;
+                    for (uint32_t i = 0; i < length; i++)
+                        sum += p[i];
+                    if (sum != p[length])
+                        goto bad;
+                    if (!decode(p, p + length)) {
+                        synced = false;
+                        goto bad;
+                    }
+                }
+                pos = (p + length + 1) - pending.data();
+                continue;
+            bad:
+                numBad++;
+                synced = false;
+                complete = false;
+                numSkipped++;
+                pos++;
+            }
+            pending.erase(pending.begin(), pending.begin() + pos);
+        }
+
+        inline size_t frames(void) const { return numFrames; }      // drawn
+        inline size_t badFrames(void) const { return numBad; }      // checksum or format errors
+        inline size_t lostFrames(void) const { return numLost; }    // good, but waiting for a key frame
+        inline size_t skippedBytes(void) const { return numSkipped; }
+        inline bool needsRedraw(void) const { return !complete; }
+
+    private:
+
+        static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v)
+        {
+            v = 0;
+            for (uint8_t shift = 0; shift < 35; shift += 7) {
+                if (p == end)
+                    return false;
+                uint8_t b = *p++;
+                v |= (uint32_t)(b & 0x7F) << shift;
+                if (!(b & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        static bool getField(const uint8_t*& p, const uint8_t* end, int32_t& v)
+        {
+            uint32_t zigzag;
+            if (!getVarint(p, end, zigzag))
+                return false;
+            v = (zigzag & 1) ? -(int32_t)(zigzag >> 1) - 1 : (int32_t)(zigzag >> 1);
+            return true;
+        }
+
+        void draw(uint8_t kind, const int32_t* f, uint16_t color)
+        {
+            switch (kind) {
+                case DisplayMirror::FILL:  canvas.fill(color); break;
+                case DisplayMirror::HLINE: canvas.hline(f[0], f[1], f[2], color); break;
+                case DisplayMirror::VLINE: canvas.vline(f[0], f[1], f[2], color); break;
+                case DisplayMirror::PIXEL: canvas.pixel(f[0], f[1], color); break;
+            }
+        }
+
+        // One payload.  Return false if it is malformed; what was drawn
+        // before the error stays drawn.
+        bool decode(const uint8_t* p, const uint8_t* end)
+        {
+            if (p == end)
+                return false;
+            uint8_t sequence = *p & 0x7F;
+            if (*p++ & DisplayMirror::KEY) {
+                memset(last, 0, sizeof(last));
+                memset(lastColor, 0, sizeof(lastColor));
+                synced = true;
+                if (p < end && *p >> 5 == DisplayMirror::FILL)
+                    complete = !(*p & DisplayMirror::F_PARTIAL);
+                else if (sequence != expected)
+                    complete = false; // missed the frames in between
+            } else if (!synced || sequence != expected) {
+                synced = false;
+                complete = false;
+                numLost++;
+                return true;
+            }
+            expected = (sequence + 1) & 0x7F;
+            numFrames++;
+
+            const uint8_t NONE = DisplayMirror::NUM_KINDS;
+            uint8_t prevKind = NONE;
+            int32_t prevDelta[3] = {0, 0, 0};
+
+            while (p < end) {
+                uint8_t header = *p++;
+                uint8_t kind = header >> 5;
+                uint8_t flags = header & 0x1F;
+
+                if (kind == DisplayMirror::TEXT) {
+                    int32_t x, y;
+                    uint32_t n;
+                    if (p == end)
+                        return false;
+                    uint8_t rotation = *p++;
+                    if (!getField(p, end, x) || !getField(p, end, y) || !getVarint(p, end, n) ||
+                        (uint32_t)(end - p) < n)
+                        return false;
+                    std::string s((const char*)p, n);
+                    p += n;
+                    canvas.text(rotation, x, y, s.data(), s.size());
+                    if (textHandler)
+                        textHandler(rotation, x, y, s);
+                    prevKind = NONE;
+                } else if (kind == DisplayMirror::RUN) {
+                    uint32_t n;
+                    if (!getVarint(p, end, n) || prevKind == NONE)
+                        return false;
+                    while (n--) {
+                        for (uint8_t k = 0; k < 3; k++)
+                            last[prevKind][k] += prevDelta[k];
+                        draw(prevKind, last[prevKind], lastColor[prevKind]);
+                    }
+                } else if (kind < DisplayMirror::TEXT) {
+                    int32_t delta[3] = {0, 0, 0};
+                    for (uint8_t k = 0; k < 3; k++)
+                        if ((flags & (1 << k)) && !getField(p, end, delta[k]))
+                            return false;
+                    if (flags & DisplayMirror::F_COLOR) {
+                        if (end - p < 2)
+                            return false;
+                        lastColor[kind] = p[0] | p[1] << 8;
+                        p += 2;
+                    }
+                    for (uint8_t k = 0; k < 3; k++)
+                        last[kind][k] += delta[k];
+                    draw(kind, last[kind], lastColor[kind]);
+                    prevKind = kind;
+                    for (uint8_t k = 0; k < 3; k++)
+                        prevDelta[k] = delta[k];
+                } else {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        MirrorCanvas& canvas;
+        TextHandler textHandler;
+        std::vector<uint8_t> pending;
+        int32_t last[DisplayMirror::TEXT][3]; // see DisplayMirror::encode()
+        uint16_t lastColor[DisplayMirror::TEXT];
+        bool synced;
+        bool complete; // everything since the last fill was drawn
+        uint8_t expected; // next sequence number
+        size_t numFrames;
+        size_t numBad;
+        size_t numSkipped;
+        size_t numLost;
+
+}; // class DisplayMirrorDecoder
+
+#endif // __DISPLAY_MIRROR_DECODER_H__
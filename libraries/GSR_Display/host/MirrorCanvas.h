@@ -0,0 +1,153 @@
+//
+// MirrorCanvas.h (host)
+// A 128x160 RGB565 framebuffer that draws the way the ST7735 driver does
+
+// Coordinates are the TFT's at rotation 0 (128 wide, 160 tall), which is how
+// GSR_Display draws everything except text.  Text is drawn like Adafruit_GFX
+// at the given rotation: 6x8 cells, wrapping at the right edge, in white,
+// background untouched.  Rotation maps like Adafruit_GFX:
+//   1: (x, y) -> (127 - y, x)    2: (127 - x, 159 - y)    3: (y, 159 - x)
+//
+// Glyphs come from Adafruit_GFX's glcdfont.c when it is on the include path
+// (-I path/to/Adafruit_GFX); without it every visible character is drawn as
+// a solid 5x7 block, so text position and length are still right.
+//
+// writePPM() saves the screen the way the status text reads: rotation 1,
+// 160 wide, 128 tall.
+
+#ifndef __MIRROR_CANVAS_H__
+#define __MIRROR_CANVAS_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__has_include)
+#if __has_include(<glcdfont.c>)
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#include <glcdfont.c>
+#define MIRROR_CANVAS_HAVE_FONT 1
+#endif
+#endif
+
+class MirrorCanvas {
+
+    public:
+
+        static const int16_t WIDTH{128};
+        static const int16_t HEIGHT{160};
+        static const uint16_t TEXT_COLOR{0xFFFF};
+
+        MirrorCanvas() { fill(0); }
+
+        void fill(uint16_t color)
+        {
+            for (int16_t y = 0; y < HEIGHT; y++)
+                for (int16_t x = 0; x < WIDTH; x++)
+                    pixels[y][x] = color;
+        }
+
+        void hline(int16_t x, int16_t y, int16_t w, uint16_t color)
+        {
+            for (int16_t i = 0; i < w; i++)
+                pixel(x + i, y, color);
+        }
+
+        void vline(int16_t x, int16_t y, int16_t h, uint16_t color)
+        {
+            for (int16_t i = 0; i < h; i++)
+                pixel(x, y + i, color);
+        }
+
+        void pixel(int16_t x, int16_t y, uint16_t color)
+        {
+            if (x >= 0 && x < WIDTH && y >= 0 && y < HEIGHT)
+                pixels[y][x] = color;
+        }
+
+        // One character at the cursor, which moves on, as Adafruit_GFX::write().
+        void write(uint8_t rotation, int16_t& cursorX, int16_t& cursorY, char c)
+        {
+            int16_t width = (rotation & 1) ? HEIGHT : WIDTH;
+            if (c == '\n') {
+                cursorX = 0;
+                cursorY += 8;
+                return;
+            }
+            if (c == '\r')
+                return;
+            if (cursorX + 6 > width) {
+                cursorX = 0;
+                cursorY += 8;
+            }
+            glyph(rotation, cursorX, cursorY, (uint8_t)c);
+            cursorX += 6;
+        }
+
+        void text(uint8_t rotation, int16_t x, int16_t y, const char* s, size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+                write(rotation, x, y, s[i]);
+        }
+
+        uint16_t at(int16_t x, int16_t y) const { return pixels[y][x]; }
+
+        bool operator==(const MirrorCanvas& other) const
+        {
+            return memcmp(pixels, other.pixels, sizeof(pixels)) == 0;
+        }
+        bool operator!=(const MirrorCanvas& other) const { return !(*this == other); }
+
+        // Binary PPM, rotation 1 (160x128).  Return false if it can't be written.
+        bool writePPM(const char* path) const
+        {
+            FILE* f = fopen(path, "wb");
+            if (!f)
+                return false;
+            fprintf(f, "P6\n%d %d\n255\n", HEIGHT, WIDTH);
+            for (int16_t y = 0; y < WIDTH; y++) {
+                for (int16_t x = 0; x < HEIGHT; x++) {
+                    uint16_t c = pixels[x][WIDTH - 1 - y];
+                    uint8_t rgb[3] = {(uint8_t)((c >> 11) * 255 / 31),
+                                      (uint8_t)(((c >> 5) & 0x3F) * 255 / 63),
+                                      (uint8_t)((c & 0x1F) * 255 / 31)};
+                    fwrite(rgb, 1, 3, f);
+                }
+            }
+            return fclose(f) == 0;
+        }
+
+    private:
+
+        // a pixel in rotated coordinates
+        void rotated(uint8_t rotation, int16_t x, int16_t y, uint16_t color)
+        {
+            switch (rotation & 3) {
+                case 0: pixel(x, y, color); break;
+                case 1: pixel(WIDTH - 1 - y, x, color); break;
+                case 2: pixel(WIDTH - 1 - x, HEIGHT - 1 - y, color); break;
+                case 3: pixel(y, HEIGHT - 1 - x, color); break;
+            }
+        }
+
+        void glyph(uint8_t rotation, int16_t x, int16_t y, uint8_t c)
+        {
+            for (int16_t i = 0; i < 5; i++) {
+#if defined(MIRROR_CANVAS_HAVE_FONT)
+                uint8_t column = font[c * 5 + i];
+#else
+                uint8_t column = (c > ' ') ? 0x7F : 0;
+#endif
+                for (int16_t j = 0; j < 8; j++, column >>= 1)
+                    if (column & 1)
+                        rotated(rotation, x + i, y + j, TEXT_COLOR);
+            }
+        }
+
+        uint16_t pixels[HEIGHT][WIDTH];
+
+}; // class MirrorCanvas
+
+#endif // __MIRROR_CANVAS_H__
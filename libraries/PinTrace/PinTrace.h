@@ -0,0 +1,126 @@
+//
+// PinTrace.h
+// record digital pin and ADC activity as a timestamped text trace
+
+// use cases:
+//   1) capture what a switch, encoder or pressure pad really did on the bench
+//   2) replay it on the host (see host/PinTraceReplay.h) to regression-test
+//      and benchmark the libraries without hardware
+
+// usage:
+//   1) instantiate with somewhere to write to (usually Serial)
+//   2) watchDigital()/watchAnalog() each pin of interest
+//   3) begin() once, after the libraries have set their pinMode()s
+//   4) update() at the top of loop(), with the same `now` the libraries get
+//
+//   PinTraceRecorder rec(Serial);
+//   rec.watchDigital(2);
+//   rec.begin();
+//   ...
+//   uint32_t now = micros();
+//   rec.update(now);
+//   mySwitch.update(now);
+
+// trace format: one event per line, fields separated by single spaces
+//   D <micros> <pin> <0|1>     digital pin now reads this
+//   A <micros> <pin> <value>   analogRead() now returns this
+//   # anything                 comment
+// Timestamps are raw micros(); they may overflow, but must not go backwards
+// by more than half the 32-bit range.
+
+// notes:
+//   1) events are written only when a value changes (analog: by MORE than
+//      the deadband), so a quiet pin costs nothing
+//   2) the trace is only as fine as the polling; call update() often
+//   3) at 115200 baud a line takes ~1.5ms; budget for that when recording
+//      fast signals
+
+#ifndef __PIN_TRACE_H__
+#define __PIN_TRACE_H__
+
+#include "Arduino.h"
+
+class PinTraceRecorder {
+
+    public:
+
+        static const uint8_t MAX_PINS{8};
+
+        explicit PinTraceRecorder(Print& output) : out(output)
+        {
+            numPins = 0;
+            events = 0;
+        }
+
+        // Return false if there is no room for another pin.
+        bool watchDigital(uint8_t pin) { return watch(pin, false, 0); }
+        bool watchAnalog(uint8_t pin, uint16_t deadband = 0) { return watch(pin, true, deadband); }
+
+        // Write the starting value of every watched pin.
+        void begin(uint32_t now = micros())
+        {
+            out.println("# PinTrace v1");
+            for (uint8_t i = 0; i < numPins; i++) {
+                last[i] = readPin(i);
+                emit(i, now, last[i]);
+            }
+        }
+
+        // Write an event for every watched pin that changed since last time.
+        void update(uint32_t now = micros())
+        {
+            for (uint8_t i = 0; i < numPins; i++) {
+                int16_t v = readPin(i);
+                int16_t change = v - last[i];
+                if (change < 0)
+                    change *= -1;
+                if (change > deadband[i]) {
+                    last[i] = v;
+                    emit(i, now, v);
+                }
+            }
+        }
+
+        inline uint32_t eventsWritten(void) const { return events; }
+
+    private:
+
+        bool watch(uint8_t pin, bool analog, uint16_t band)
+        {
+            if (numPins >= MAX_PINS)
+                return false;
+            pins[numPins] = pin;
+            isAnalog[numPins] = analog;
+            deadband[numPins] = analog ? band : 0;
+            last[numPins] = 0;
+            numPins++;
+            return true;
+        }
+
+        int16_t readPin(uint8_t i)
+        {
+            return isAnalog[i] ? analogRead(pins[i]) : digitalRead(pins[i]);
+        }
+
+        void emit(uint8_t i, uint32_t now, int16_t value)
+        {
+            out.print(isAnalog[i] ? "A " : "D ");
+            out.print(now);
+            out.print(' ');
+            out.print(pins[i]);
+            out.print(' ');
+            out.println(value);
+            events++;
+        }
+
+        Print&   out;
+        uint8_t  numPins;
+        uint8_t  pins[MAX_PINS];
+        bool     isAnalog[MAX_PINS];
+        uint16_t deadband[MAX_PINS];
+        int16_t  last[MAX_PINS]; // last value written
+        uint32_t events;
+
+}; // class PinTraceRecorder
+
+#endif // __PIN_TRACE_H__
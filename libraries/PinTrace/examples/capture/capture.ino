@@ -0,0 +1,41 @@
+//
+// Example usage of PinTraceRecorder
+// Records the switch, encoder and pressure pads used by
+// examples/replay_bench, so a bench session can be replayed on the host.
+//
+// Capture with e.g.
+//   $ cat /dev/ttyACM0 > session.trace
+
+#include "PinTrace.h"
+#include "SimpleSwitch.h"
+#include "RotaryEncoder.h"
+#include "QuadPressurePad.h"
+
+SimpleSwitch button(2);
+RotaryEncoder knob(3, 4);
+QuadPressurePad pad(A0, A1, A2, A3);
+PinTraceRecorder rec(Serial);
+
+void setup() {
+    Serial.begin(115200);
+    while (!Serial) {} // wait for the host to start listening
+
+    rec.watchDigital(2);
+    rec.watchDigital(3);
+    rec.watchDigital(4);
+    rec.watchAnalog(A0, 4); // ignore +-4 counts of ADC noise
+    rec.watchAnalog(A1, 4);
+    rec.watchAnalog(A2, 4);
+    rec.watchAnalog(A3, 4);
+    rec.begin();
+}
+
+void loop() {
+    // record first, with the same timestamp the libraries will see
+    uint32_t now = micros();
+    rec.update(now);
+
+    button.update(now);
+    knob.update();
+    pad.update();
+}
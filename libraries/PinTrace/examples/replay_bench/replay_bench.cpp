@@ -0,0 +1,254 @@
+//
+// replay_bench.cpp (host)
+// Replays a pin trace through each library and reports how fast it runs.
+//
+// build: see ../../README.md
+//
+// run:
+//   ./replay_bench                 # synthesized 60 second session
+//   ./replay_bench my.trace        # a trace captured with examples/capture
+//   ./replay_bench -s out.trace    # also save the synthesized session
+//
+// Pin map (same as examples/capture):
+//   2      switch (active low)
+//   3, 4   rotary encoder A, B
+//   A0-A3  pressure pads
+//
+// Timing covers the library alone: a pass that only steps the trace is
+// timed first and subtracted.
+//
+// The "result" column is a digest of what the library decided (presses,
+// detents, touches...).  It depends only on the trace.  For the synthesized
+// session the expected digests are below, and a difference is flagged and
+// makes the exit status 1, so a change in debouncing, decoding or touch
+// detection shows up here.
+
+#include "PinTraceReplay.h"
+#include "SimpleSwitch.h"
+#include "SoftwareSwitch.h"
+#include "RotaryEncoder.h"
+#include "QuadPressurePad.h"
+#include "Digipot_MAX5160.h"
+#include "EventTimer.h"
+
+#include <algorithm>
+#include <chrono>
+
+static const uint8_t SWITCH_PIN{2};
+static const uint8_t ENC_A_PIN{3};
+static const uint8_t ENC_B_PIN{4};
+static const uint8_t PAD_PIN[4] = {A0, A1, A2, A3};
+static const uint32_t LOOP_MICROS{50}; // simulated loop() period
+
+// digests of the synthesized session, in bench order
+static const long EXPECTED[] = {
+    299,      // SimpleSwitch: pressed() once per press
+    299,      // SoftwareSwitch
+    232,      // RotaryEncoder: sum of direction()
+    1861,     // QuadPressurePad
+    19217227, // Digipot: sum of wiper positions
+    60053,    // EventTimer: expired once per ms
+};
+
+// deterministic noise
+static uint32_t lcg(uint32_t& seed)
+{
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// A made-up but realistic session: a bouncy button pressed every 200ms,
+// an encoder turned back and forth at varying speed, and noisy pads that
+// get touched now and then.
+static void synthesize(PinTraceReplay& trace, uint32_t seconds)
+{
+    struct Ev { uint64_t t; uint8_t pin; bool analog; int16_t v; };
+    std::vector<Ev> ev;
+    uint32_t seed = 12345;
+    const uint64_t end = (uint64_t)seconds * 1000000;
+
+    // initial state
+    ev.push_back(Ev{0, SWITCH_PIN, false, 1});
+    ev.push_back(Ev{0, ENC_A_PIN, false, 1});
+    ev.push_back(Ev{0, ENC_B_PIN, false, 1});
+    for (uint8_t i = 0; i < 4; i++)
+        ev.push_back(Ev{0, PAD_PIN[i], true, 300});
+
+    // switch: press at 200ms intervals, held 80ms, ~2ms of bounce each edge
+    for (uint64_t t = 100000; t + 100000 < end; t += 200000) {
+        for (int edge = 0; edge < 2; edge++) {
+            uint64_t at = t + (edge ? 80000 : 0);
+            bool settled = edge ? 1 : 0;
+            for (int b = 0; b < 6; b++) {
+                at += 100 + lcg(seed) % 300;
+                ev.push_back(Ev{at, SWITCH_PIN, false, (int16_t)(b % 2 ? settled : !settled)});
+            }
+            ev.push_back(Ev{at + 200, SWITCH_PIN, false, settled});
+        }
+    }
+
+    // encoder: bursts of 1..40 detents, 0.3..20ms per quadrature step
+    static const uint8_t gray[4] = {3, 2, 0, 1}; // AB, one detent = 4 steps
+    int phase = 0;
+    for (uint64_t t = 50000; t < end; t += 250000) {
+        int dir = (lcg(seed) & 1) ? 1 : -1;
+        uint32_t steps = 4 * (1 + lcg(seed) % 40);
+        uint32_t stepMicros = 300 + lcg(seed) % 20000;
+        uint64_t at = t;
+        for (uint32_t s = 0; s < steps && at < t + 240000; s++) {
+            at += stepMicros;
+            phase = (phase + dir) & 3;
+            ev.push_back(Ev{at, ENC_A_PIN, false, (int16_t)((gray[phase] >> 1) & 1)});
+            ev.push_back(Ev{at, ENC_B_PIN, false, (int16_t)(gray[phase] & 1)});
+        }
+    }
+
+    // pads: a new reading every 1ms, +-8 counts of noise,
+    // one of them pressed for 150ms every 700ms
+    for (uint64_t t = 1000; t < end; t += 1000) {
+        bool touch = (t % 700000) < 150000 && t > 700000;
+        for (uint8_t i = 0; i < 4; i++) {
+            int v = 300 + (int)(lcg(seed) % 17) - 8;
+            if (touch && i == (t / 700000) % 4)
+                v += 350;
+            ev.push_back(Ev{t, PAD_PIN[i], true, (int16_t)v});
+        }
+    }
+
+    std::stable_sort(ev.begin(), ev.end(), [](const Ev& a, const Ev& b) { return a.t < b.t; });
+    trace.clear();
+    for (size_t i = 0; i < ev.size(); i++)
+        trace.add(ev[i].t, ev[i].pin, ev[i].analog, ev[i].v);
+}
+
+// Construct the way a sketch's globals are: in zero-initialized static
+// storage.  Some of the libraries rely on that for members they don't set.
+template <typename T, typename... Args>
+static T& makeGlobal(Args... args)
+{
+    static T instance(args...);
+    return instance;
+}
+
+// Seconds to step through the whole trace without calling anything.
+static double harness(PinTraceReplay& trace)
+{
+    HostHAL::reset();
+    trace.rewind();
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t t = trace.startTime(); t <= trace.endTime(); t += LOOP_MICROS)
+        trace.advanceTo(t);
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(stop - start).count();
+}
+
+// Step the trace in LOOP_MICROS increments, calling body() each step.
+// Report updates per second and speed relative to real time, both without
+// the stepping, and check the digest against `expected` (0: don't).
+// Return false if it differs.
+template <typename Setup, typename Body>
+static bool bench(const char* name, PinTraceReplay& trace, long expected, Setup setup, Body body)
+{
+    double stepping = harness(trace);
+
+    HostHAL::reset();
+    trace.rewind();
+    trace.advanceTo(trace.startTime());
+    auto& state = setup();
+
+    uint64_t updates = 0;
+    long result = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t t = trace.startTime(); t <= trace.endTime(); t += LOOP_MICROS) {
+        trace.advanceTo(t);
+        result += body(state);
+        updates++;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    double wall = std::chrono::duration<double>(stop - start).count() - stepping;
+    if (wall < 1e-9)
+        wall = 1e-9; // faster than the clock can tell
+    double simulated = (trace.endTime() - trace.startTime()) / 1e6;
+    bool ok = !expected || result == expected;
+    char check[24] = "";
+    if (!ok)
+        snprintf(check, sizeof(check), "  EXPECTED %ld", expected);
+    printf("%-16s %10llu %8.1f %12.0f %10.0fx %10ld%s\n", name,
+           (unsigned long long)updates, wall * 1e9 / updates, updates / wall,
+           simulated / wall, result, check);
+    return ok;
+}
+
+int main(int argc, char** argv)
+{
+    PinTraceReplay trace;
+    const char* saveAs = 0;
+    const char* loadFrom = 0;
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            saveAs = argv[++i];
+        else
+            loadFrom = argv[i];
+    }
+
+    if (loadFrom) {
+        if (!trace.load(loadFrom)) {
+            fprintf(stderr, "%s: can't read trace (line %lu)\n", loadFrom, trace.errorAt());
+            return 1;
+        }
+    } else {
+        synthesize(trace, 60);
+    }
+    if (saveAs && !trace.save(saveAs)) {
+        fprintf(stderr, "%s: can't write trace\n", saveAs);
+        return 1;
+    }
+
+    printf("%lu events, %.1f s of pins, loop() every %lu us\n\n",
+           (unsigned long)trace.size(), (trace.endTime() - trace.startTime()) / 1e6,
+           (unsigned long)LOOP_MICROS);
+    printf("%-16s %10s %8s %12s %11s %10s\n",
+           "library", "updates", "ns/upd", "updates/s", "vs. real", "result");
+
+    // a loaded trace has no expected digests
+    static const long NONE[6] = {0, 0, 0, 0, 0, 0};
+    const long* expect = loadFrom ? NONE : EXPECTED;
+    bool ok = true;
+
+    ok &= bench("SimpleSwitch", trace, expect[0],
+          []() -> SimpleSwitch& { return makeGlobal<SimpleSwitch>(SWITCH_PIN); },
+          [](SimpleSwitch& s) { s.update(); return s.pressed() ? 1 : 0; });
+
+    ok &= bench("SoftwareSwitch", trace, expect[1],
+          []() -> SoftwareSwitch& { auto& s = makeGlobal<SoftwareSwitch>(SWITCH_PIN);
+                                     s.begin(10000); return s; },
+          [](SoftwareSwitch& s) { s.update(); return s.isPressed() ? 1 : 0; });
+
+    ok &= bench("RotaryEncoder", trace, expect[2],
+          []() -> RotaryEncoder& { auto& e = makeGlobal<RotaryEncoder>(ENC_A_PIN, ENC_B_PIN);
+                                    e.update(); e.direction(); return e; },
+          [](RotaryEncoder& e) { e.update(); return (int)e.direction(); });
+
+    ok &= bench("QuadPressurePad", trace, expect[3],
+          []() -> QuadPressurePad& { return makeGlobal<QuadPressurePad>(PAD_PIN[0], PAD_PIN[1],
+                                                                     PAD_PIN[2], PAD_PIN[3]); },
+          [](QuadPressurePad& p) { p.update(); return p.isTouched() ? 1 : 0; });
+
+    ok &= bench("Digipot", trace, expect[4],
+          []() -> Digipot& { return makeGlobal<Digipot>(5, 6, 7); },
+          [](Digipot& d) { static int8_t dir = 1;
+                           uint8_t pos = d.wiperMove(dir);
+                           if (pos == 0 || pos == 32) dir = -dir;
+                           return (int)pos; });
+
+    ok &= bench("EventTimer", trace, expect[5],
+          []() -> EventTimer& { auto& t = makeGlobal<EventTimer>(1000); t.begin(); return t; },
+          [](EventTimer& t) { t.update(); return t.hasExpired() ? 1 : 0; });
+
+    if (!ok) {
+        fprintf(stderr, "results differ from the expected digests\n");
+        return 1;
+    }
+    return 0;
+}
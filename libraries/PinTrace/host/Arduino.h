@@ -0,0 +1,223 @@
+//
+// Arduino.h (host)
+// stand-in for the Arduino core, for running these libraries on a PC
+
+// Put this directory FIRST on the include path and the libraries compile
+// unchanged.  Time and pins are simulated:
+//   1) micros()/millis() read a 64-bit virtual clock that only moves when
+//      you say so (HostHAL::advanceMicros(), delay(), HostHAL::sleepMicros()
+//      or a PinTraceReplay)
+//   2) digitalRead()/analogRead() return whatever was last set with
+//      HostHAL::setDigital()/setAnalog() (or by a replayed trace);
+//      an untouched INPUT_PULLUP pin reads HIGH
+//   3) digitalWrite() and pinMode() are remembered, so tests can look at them
+//   4) Serial prints to stdout
+//
+// Everything is header-only; there is nothing to link.  Each thread has its
+// own clock and pins.
+
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+#define ARDUINO 10605
+#define ARDUINO_HOST 1
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT        0x0
+#define OUTPUT       0x1
+#define INPUT_PULLUP 0x2
+
+// Teensy 3.x numbering
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+#define A8 22
+#define A9 23
+
+#define HOST_NUM_PINS 64
+
+class HostHAL {
+
+    public:
+
+        // Put every pin and the clock back to power-on state.
+        static void reset(void)
+        {
+            State& s = state();
+            memset(&s, 0, sizeof(s));
+        }
+
+        // virtual clock
+        static uint64_t now(void) { return state().clock; }
+        static void setMicros(uint64_t t) { state().clock = t; }
+        static void advanceMicros(uint64_t dt) { state().clock += dt; }
+
+        // low-power waits: the clock jumps ahead by the requested time plus
+        // a simulated wake-up latency
+        static void sleepMicros(uint32_t dt) { state().clock += dt + state().wakeLatency; }
+        static void setWakeLatency(uint32_t us) { state().wakeLatency = us; }
+
+        // inputs, as the outside world drives them
+        static void setDigital(uint8_t pin, bool value)
+        {
+            if (pin >= HOST_NUM_PINS) return;
+            state().digital[pin] = value;
+            state().driven[pin] = true;
+        }
+        static void setAnalog(uint8_t pin, int value)
+        {
+            if (pin >= HOST_NUM_PINS) return;
+            state().analog[pin] = value;
+        }
+
+        // outputs, as the libraries drive them
+        static uint8_t getMode(uint8_t pin)
+        {
+            return pin < HOST_NUM_PINS ? state().mode[pin] : INPUT;
+        }
+        static bool getOutput(uint8_t pin)
+        {
+            return pin < HOST_NUM_PINS ? state().output[pin] : false;
+        }
+        static uint32_t getOutputEdges(uint8_t pin) // digitalWrite() changes seen
+        {
+            return pin < HOST_NUM_PINS ? state().edges[pin] : 0;
+        }
+
+        // used by the Arduino functions below
+        static int readDigital(uint8_t pin)
+        {
+            if (pin >= HOST_NUM_PINS) return LOW;
+            const State& s = state();
+            if (s.mode[pin] == OUTPUT) return s.output[pin];
+            if (!s.driven[pin]) return s.mode[pin] == INPUT_PULLUP ? HIGH : LOW;
+            return s.digital[pin];
+        }
+        static int readAnalog(uint8_t pin)
+        {
+            return pin < HOST_NUM_PINS ? state().analog[pin] : 0;
+        }
+        static void writeDigital(uint8_t pin, uint8_t value)
+        {
+            if (pin >= HOST_NUM_PINS) return;
+            State& s = state();
+            bool v = value != LOW;
+            if (v != s.output[pin]) s.edges[pin]++;
+            s.output[pin] = v;
+        }
+        static void setMode(uint8_t pin, uint8_t mode)
+        {
+            if (pin < HOST_NUM_PINS) state().mode[pin] = mode;
+        }
+
+    private:
+
+        struct State {
+            uint64_t clock;
+            uint32_t wakeLatency;
+            bool     digital[HOST_NUM_PINS];
+            bool     driven[HOST_NUM_PINS]; // has the outside world set it?
+            int      analog[HOST_NUM_PINS];
+            uint8_t  mode[HOST_NUM_PINS];
+            bool     output[HOST_NUM_PINS];
+            uint32_t edges[HOST_NUM_PINS];
+        };
+
+        static State& state(void)
+        {
+            // one simulated world per thread, so sessions can be replayed
+            // in parallel; zero-initialized
+            static thread_local State s;
+            return s;
+        }
+
+}; // class HostHAL
+
+inline uint32_t micros(void) { return (uint32_t)HostHAL::now(); }
+inline uint32_t millis(void) { return (uint32_t)(HostHAL::now() / 1000); }
+inline void delayMicroseconds(uint32_t us) { HostHAL::advanceMicros(us); }
+inline void delay(uint32_t ms) { HostHAL::advanceMicros((uint64_t)ms * 1000); }
+
+inline void pinMode(uint8_t pin, uint8_t mode) { HostHAL::setMode(pin, mode); }
+inline int  digitalRead(uint8_t pin) { return HostHAL::readDigital(pin); }
+inline void digitalWrite(uint8_t pin, uint8_t value) { HostHAL::writeDigital(pin, value); }
+inline int  analogRead(uint8_t pin) { return HostHAL::readAnalog(pin); }
+inline void analogWrite(uint8_t, int) {}
+
+// there are no interrupts on the host
+inline void noInterrupts(void) {}
+inline void interrupts(void) {}
+
+// just enough of Print for Serial.print()-style output
+class Print {
+
+    public:
+
+        virtual ~Print() {}
+        virtual size_t write(uint8_t c) = 0;
+        virtual size_t write(const uint8_t* buf, size_t n)
+        {
+            size_t sent = 0;
+            while (n--) sent += write(*buf++);
+            return sent;
+        }
+
+        size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+        size_t print(char c) { return write((uint8_t)c); }
+        size_t print(long n) { return printf_("%ld", n); }
+        size_t print(unsigned long n) { return printf_("%lu", n); }
+        size_t print(int n) { return print((long)n); }
+        size_t print(unsigned n) { return print((unsigned long)n); }
+        size_t print(double d, int digits = 2) { return printf_("%.*f", digits, d); }
+
+        size_t println(void) { return write((const uint8_t*)"\r\n", 2); }
+        template <typename T> size_t println(T x) { size_t n = print(x); return n + println(); }
+
+    private:
+
+        size_t printf_(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+}; // class Print
+
+#include <stdarg.h>
+inline size_t Print::printf_(const char* fmt, ...)
+{
+    char buf[64];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, ap);
+    va_end(ap);
+    if (n < 0) return 0;
+    return write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? n : sizeof(buf) - 1);
+}
+
+class HostSerial : public Print {
+
+    public:
+
+        void begin(unsigned long) {}
+        operator bool() const { return true; }
+        size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+        using Print::write;
+
+}; // class HostSerial
+
+static HostSerial Serial; // no state of its own: one per translation unit is fine
+
+#endif // __HOST_ARDUINO_H__
@@ -0,0 +1,158 @@
+//
+// PinTraceReplay.h (host)
+// play a PinTrace back through the host Arduino stand-in
+
+// usage:
+//   1) load() a trace written by PinTraceRecorder, or add() events by hand
+//   2) construct the library under test (it calls pinMode() as usual)
+//   3) rewind(), then step the clock with advanceTo(); every event up to and
+//      including that time is applied to the simulated pins first
+//
+//   PinTraceReplay trace;
+//   trace.load("switch.trace");
+//   SimpleSwitch sw(2);
+//   trace.rewind();
+//   for (uint64_t t = trace.startTime(); !trace.done(); t += 100) {
+//       trace.advanceTo(t);
+//       sw.update();
+//       if (sw.pressed()) presses++;
+//   }
+
+// notes:
+//   1) times are kept as 64-bit microseconds; 32-bit overflows in a recorded
+//      trace are unwrapped on load, so long sessions replay correctly
+//   2) the clock never goes backwards; advanceTo() an earlier time is a no-op
+
+#ifndef __PIN_TRACE_REPLAY_H__
+#define __PIN_TRACE_REPLAY_H__
+
+#include "Arduino.h"
+#include <vector>
+
+struct PinTraceEvent {
+    uint64_t time;
+    uint8_t  pin;
+    bool     analog;
+    int16_t  value;
+};
+
+class PinTraceReplay {
+
+    public:
+
+        PinTraceReplay() { clear(); }
+
+        void clear(void)
+        {
+            events.clear();
+            next = 0;
+            lastRaw = 0;
+            errorLine = 0;
+        }
+
+        // Append one event.  Keep times non-decreasing.
+        void add(uint64_t time, uint8_t pin, bool analog, int16_t value)
+        {
+            PinTraceEvent e = {time, pin, analog, value};
+            events.push_back(e);
+        }
+
+        // Read a trace file, appending to whatever is already loaded.
+        // Return false if the file can't be opened or a line can't be parsed
+        // (see errorAt() for the line number).
+        bool load(const char* path)
+        {
+            FILE* f = fopen(path, "r");
+            if (!f)
+                return false;
+            bool ok = parse(f);
+            fclose(f);
+            return ok;
+        }
+
+        bool parse(FILE* f)
+        {
+            char line[80];
+            unsigned long lineNumber = 0;
+            uint64_t t64 = events.empty() ? 0 : events.back().time;
+            bool first = events.empty();
+            while (fgets(line, sizeof(line), f)) {
+                lineNumber++;
+                char kind;
+                unsigned long raw;
+                unsigned pin;
+                int value;
+                if (line[0] == '#' || line[0] == '\n' || line[0] == '\r')
+                    continue;
+                if (sscanf(line, "%c %lu %u %d", &kind, &raw, &pin, &value) != 4
+                        || (kind != 'D' && kind != 'A') || pin >= HOST_NUM_PINS) {
+                    errorLine = lineNumber;
+                    return false;
+                }
+                // unwrap micros() overflow
+                if (first)
+                    t64 = (uint32_t)raw;
+                else
+                    t64 += (uint32_t)((uint32_t)raw - lastRaw);
+                first = false;
+                lastRaw = (uint32_t)raw;
+                add(t64, pin, kind == 'A', value);
+            }
+            return true;
+        }
+
+        // Write the trace back out in the text format (e.g. a synthesized one).
+        bool save(const char* path) const
+        {
+            FILE* f = fopen(path, "w");
+            if (!f)
+                return false;
+            fprintf(f, "# PinTrace v1\n");
+            for (size_t i = 0; i < events.size(); i++) {
+                const PinTraceEvent& e = events[i];
+                fprintf(f, "%c %lu %u %d\n", e.analog ? 'A' : 'D',
+                        (unsigned long)(uint32_t)e.time, e.pin, e.value);
+            }
+            return fclose(f) == 0;
+        }
+
+        // Start over: clock to the first event, nothing applied yet.
+        void rewind(void)
+        {
+            next = 0;
+            HostHAL::setMicros(startTime());
+        }
+
+        // Move the clock to `t`, applying every event at or before it.
+        void advanceTo(uint64_t t)
+        {
+            if (t < HostHAL::now())
+                return;
+            while (next < events.size() && events[next].time <= t) {
+                const PinTraceEvent& e = events[next++];
+                if (e.analog)
+                    HostHAL::setAnalog(e.pin, e.value);
+                else
+                    HostHAL::setDigital(e.pin, e.value != 0);
+            }
+            HostHAL::setMicros(t);
+        }
+
+        inline bool done(void) const { return next >= events.size(); }
+        inline size_t size(void) const { return events.size(); }
+        inline unsigned long errorAt(void) const { return errorLine; }
+        inline const PinTraceEvent& operator[](size_t i) const { return events[i]; }
+
+        uint64_t startTime(void) const { return events.empty() ? 0 : events.front().time; }
+        uint64_t endTime(void) const { return events.empty() ? 0 : events.back().time; }
+
+    private:
+
+        std::vector<PinTraceEvent> events;
+        size_t next;            // first event not yet applied
+        uint32_t lastRaw;       // previous timestamp as read from the file
+        unsigned long errorLine;
+
+}; // class PinTraceReplay
+
+#endif // __PIN_TRACE_REPLAY_H__
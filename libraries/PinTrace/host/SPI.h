@@ -0,0 +1,63 @@
+//
+// SPI.h (host)
+// stand-in for the Arduino SPI library
+//
+// Nothing is attached to the bus: transfer() returns 0 and counts bytes, so
+// a benchmark can tell how much traffic a library would have generated.
+
+#ifndef __HOST_SPI_H__
+#define __HOST_SPI_H__
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+#define SPI_MODE1 0x04
+#define SPI_MODE2 0x08
+#define SPI_MODE3 0x0C
+
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+#define SPI_CLOCK_DIV2 0x04
+#define SPI_CLOCK_DIV4 0x00
+
+class SPISettings {
+    public:
+        SPISettings() {}
+        SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass {
+
+    public:
+
+        void begin(void) {}
+        void end(void) {}
+        void beginTransaction(SPISettings) {}
+        void endTransaction(void) {}
+        void setBitOrder(uint8_t) {}
+        void setDataMode(uint8_t) {}
+        void setClockDivider(uint8_t) {}
+
+        uint8_t transfer(uint8_t) { bytes()++; return 0; }
+        uint16_t transfer16(uint16_t) { bytes() += 2; return 0; }
+        void transfer(void*, size_t n) { bytes() += n; }
+
+        // bytes clocked out since the last resetCount()
+        uint32_t count(void) const { return bytes(); }
+        void resetCount(void) { bytes() = 0; }
+
+    private:
+        // one count per simulated world (thread), like HostHAL::state():
+        // every translation unit has its own `SPI`, but they all count here
+        static uint32_t& bytes(void)
+        {
+            static thread_local uint32_t n = 0;
+            return n;
+        }
+
+}; // class SPIClass
+
+static SPIClass SPI; // no state of its own, see bytes()
+
+#endif // __HOST_SPI_H__
@@ -0,0 +1,8 @@
+//
+// WProgram.h (host)
+// pre-1.0 name for Arduino.h
+
+#ifndef __HOST_WPROGRAM_H__
+#define __HOST_WPROGRAM_H__
+#include "Arduino.h"
+#endif // __HOST_WPROGRAM_H__
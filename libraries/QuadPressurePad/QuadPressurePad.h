@@ -38,6 +38,9 @@ class QuadPressurePad {
 
     public:
 
+        static const uint8_t NUM_PADS{4};
+        static const uint8_t NUM_SAMPLES{16}; // length of the moving average
+
         // 4 analogRead()-able pins
         //
         // Currently this does not care about orientation,
@@ -50,6 +53,15 @@ class QuadPressurePad {
             padPin[2] = PAD_2;
             padPin[3] = PAD_3;
             touched = false;
+            sensitivity = 100;
+            historyIndex = 0;
+            // start from the same (empty) history as a global instance would
+            for (uint8_t i = 0; i < NUM_PADS; i++) {
+                pads[i] = 0;
+                movingPadAvg[i] = 0;
+                for (uint8_t j = 0; j < NUM_SAMPLES; j++)
+                    padHistory[i][j] = 0;
+            }
         }
 
         // Update the values in pads[]
@@ -63,12 +75,38 @@ class QuadPressurePad {
             updateMotion();
         }
 
+        // Same as update(), but with readings taken elsewhere (e.g. by a
+        // SampleEngine at a fixed rate).  values[] holds one reading per pad,
+        // in the order the pins were given to the constructor.
+        //
+        // Call this function once per sample.
+        void update(const int16_t* values)
+        {
+            for (uint8_t i = 0; i < NUM_PADS; i++)
+                pads[i] = values[i];
+            updateAllPads();
+            updateMotion();
+        }
+
         // Return (a pointer to) the array of readings of the pads.
         int16_t* rawValues()
         {
             return pads;
         }
 
+        // Return (a pointer to) the moving average of each pad.
+        const int16_t* averages() const
+        {
+            return movingPadAvg;
+        }
+
+        // A touch is a reading more than `threshold` away from its pad's
+        // moving average.  Default: 100.
+        void setSensitivity(int16_t threshold)
+        {
+            sensitivity = threshold;
+        }
+
         // Was the pad touched?
         // Note: this will return true at most once per update() cycle.
         //
@@ -84,19 +122,19 @@ class QuadPressurePad {
     private:
 
         // Update the history of all 4 pads, column-wise, in one go.
-        //
-        // NOTE: contains static variable for the sample index
         // Do once per update()
         void updateAllPads()
         {
-            static uint8_t index{0};
             for (uint8_t i = 0; i < NUM_PADS; i++)
-                padHistory[i][index] = pads[i];
-            index = (index + 1) % NUM_SAMPLES;
+                padHistory[i][historyIndex] = pads[i];
+            historyIndex = (historyIndex + 1) % NUM_SAMPLES;
         }
 
         // Calculate the average value of a single pad over the most recent N samples.
         // Do once per update()
+        //
+        // NOTE: sum is truncated to an integer after every term, in slot order.
+        // Host-side reimplementations (BatchAnalysis) depend on this exactly.
         int16_t getSinglePadAverage(uint8_t padIndex)
         {
             int16_t sum{0};
@@ -115,17 +153,17 @@ class QuadPressurePad {
                 int16_t deviation{pads[i] - movingPadAvg[i]};
                 if (deviation < 0)
                     deviation *= -1;
-                if (deviation > 100) // hard-coded sensitivity value
+                if (deviation > sensitivity)
                     touched = true;
             }
         }
 
-        static const uint8_t NUM_PADS{4};
-        static const uint8_t NUM_SAMPLES{16};
         uint8_t padPin[NUM_PADS]; // index to the physical pin
         int16_t pads[NUM_PADS]; // current value
         int16_t padHistory[NUM_PADS][NUM_SAMPLES]; // history of pad values
         int16_t movingPadAvg[NUM_PADS]; // average of historical values
+        uint8_t historyIndex; // next slot of padHistory to write
+        int16_t sensitivity;
         bool touched;
 
 }; // class QuadPressurePad
@@ -14,22 +14,21 @@ const int8_t RotaryEncoder::stateTransitionTable [16] =
    2,  1, -1,  0
 };
 
-int8_t RotaryEncoder::_position = 0; // static
-
 // constructor/destructor
 RotaryEncoder::RotaryEncoder (uint8_t pinA, uint8_t pinB)
 {
   _pinA = pinA;
   _pinB = pinB;
+  _position = 0;
   pinMode(_pinA, INPUT_PULLUP);
   pinMode(_pinB, INPUT_PULLUP);
 };
 RotaryEncoder::~RotaryEncoder() {};
 
 // High-level functions
-void RotaryEncoder::update(void)
+void RotaryEncoder::update(uint32_t now)
 {
-  _knobPos = position() / 4; // because 4x count
+  _knobPos = advance(now) / 4; // because 4x count
 }
 
 int8_t RotaryEncoder::direction(void)
@@ -44,9 +43,72 @@ int8_t RotaryEncoder::direction(void)
 
 int8_t RotaryEncoder::position(void)
 { // Divide by 4 or take modulus for "detent"-based steps.
+  uint32_t now = micros();
+  noInterrupts(); // update() may be running from a pin interrupt
+  int8_t p = advance(now);
+  interrupts();
+  return p;
+}
+
+int16_t RotaryEncoder::detents(void)
+{
+  noInterrupts();
+  int16_t d = _pendingDetents;
+  _pendingDetents = 0;
+  interrupts();
+  return d;
+}
+
+int32_t RotaryEncoder::delta(void)
+{
+  noInterrupts();
+  int32_t d = _pendingDelta;
+  _pendingDelta = 0;
+  interrupts();
+  return d;
+}
+
+uint32_t RotaryEncoder::detentInterval(void)
+{
+  uint32_t now = micros();
+  noInterrupts();
+  uint32_t interval = _interval;
+  uint32_t last = _lastDetent;
+  interrupts();
+  return (now - last < IDLE_MICROS) ? interval : 0;
+}
+
+void RotaryEncoder::setAcceleration(const EncoderAccel* curve, uint8_t points, bool interpolate)
+{
+  noInterrupts();
+  _curve = curve;
+  _curvePoints = curve ? points : 0;
+  _interpolate = interpolate;
+  interrupts();
+}
+
+// Low-level functions
+int8_t RotaryEncoder::advance(uint32_t now)
+{
   int8_t val = read();
-  if (val != 2) // ignore error state
+  if (val != 2) { // position() and the knob ignore the error state, as always
     _position += val;
+    if (val != 0)
+      _lastStep = val;
+    _count += val;
+  } else {
+    // both pins changed: a state was skipped.  For detents()/delta() only,
+    // assume it kept going, so a fast spin doesn't lose detents.
+    _count += 2 * _lastStep;
+  }
+  while (_count >= 4) {
+    _count -= 4;
+    detent(1, now);
+  }
+  while (_count <= -4) {
+    _count += 4;
+    detent(-1, now);
+  }
   return _position;
 }
 
@@ -57,6 +119,48 @@ int8_t RotaryEncoder::read(void)
   return stateTransitionTable[oldState * 4 + currentState];
 }
 
+// Estimate speed from the time between detents, then count this one.
+// The first detent of a run (or after a reversal) has no speed yet.
+void RotaryEncoder::detent(int8_t dir, uint32_t now)
+{
+  uint32_t dt = now - _lastDetent;
+  if (dir != _lastDir || dt >= IDLE_MICROS)
+    _interval = 0;
+  else if (_interval == 0)
+    _interval = dt;
+  else
+    _interval = (_interval + dt) / 2; // smooth out uneven detents
+  _lastDir = dir;
+  _lastDetent = now;
+
+  _pendingDetents += dir;
+  _pendingDelta += dir * (int32_t)multiplier(_interval);
+}
+
+// Steps per detent for a given detent interval.
+uint16_t RotaryEncoder::multiplier(uint32_t interval)
+{
+  if (interval == 0 || _curvePoints == 0)
+    return 1;
+  for (uint8_t i = 0; i < _curvePoints; i++) {
+    if (interval > _curve[i].maxInterval)
+      continue;
+    if (!_interpolate || i == 0)
+      return _curve[i].multiplier;
+
+    // between the next faster point and this one
+    const EncoderAccel& fast = _curve[i - 1];
+    const EncoderAccel& slow = _curve[i];
+    uint32_t span = slow.maxInterval - fast.maxInterval;
+    if (span == 0)
+      return slow.multiplier;
+    uint32_t frac = ((interval - fast.maxInterval) << 8) / span; // 0..256
+    int32_t m = fast.multiplier + (((int32_t)slow.multiplier - fast.multiplier) * (int32_t)frac) / 256;
+    return m > 0 ? m : 1;
+  }
+  return 1;
+}
+
 // getters and setters
 void RotaryEncoder::setKnobPosition(int8_t knobPos = 0)
 { // default to zero
@@ -67,4 +171,3 @@ int8_t RotaryEncoder::getKnobPosition(void)
 {
   return _knobPos;
 }
-
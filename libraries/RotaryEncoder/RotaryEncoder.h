@@ -6,11 +6,43 @@
 // Copyright (c) 2014 Trustees of Indiana University
 //
 
+// Two ways to read the knob:
+//   1) direction()/getKnobPosition(): one detent at a time, as before
+//   2) detents()/delta(): everything since the last call, so nothing is lost
+//      when loop() is slow.  delta() is scaled by an acceleration curve, so
+//      a fast spin covers a big range and a slow one stays precise.
+//
+// update() may also be called from a CHANGE interrupt on both pins; then
+// detents() and delta() keep up no matter what loop() is doing.  position()
+// also reads the pins, so it turns interrupts off while it does.
+//
+// A transition that skips a state (both pins changed at once) is ignored by
+// position() and the knob position; detents() and delta() count it as two
+// steps in the last direction, so a fast spin doesn't lose detents.
+//
+// Acceleration curve: points sorted by maxInterval, fastest first.
+// A detent arriving maxInterval microseconds or less after the previous one
+// counts `multiplier` steps; slower than the last point counts 1.
+//
+//   const EncoderAccel curve[] = {
+//       { 5000, 50},  // > 200 detents/s
+//       {15000, 10},  // >  66 detents/s
+//       {40000,  1},
+//   };
+//   knob.setAcceleration(curve, 3);
+//   ...
+//   value = constrain(value + knob.delta(), 0, 1000);
+
 #ifndef __PANEL_ENCODER_H__
 #define __PANEL_ENCODER_H__
 
 #include "Arduino.h"
 
+struct EncoderAccel {
+    uint32_t maxInterval; // microseconds between detents
+    uint16_t multiplier;  // steps per detent at (or above) this speed
+};
+
 class RotaryEncoder
 {
 
@@ -18,25 +50,50 @@ class RotaryEncoder
     RotaryEncoder(uint8_t pinA, uint8_t pinB);
     ~RotaryEncoder();
 
-    void update(void);      // read inputs
+    void update(uint32_t now = micros()); // read inputs
 
     int8_t position(void);  // returns current (relative) position
     int8_t direction(void); // returns (-1, 0, 1) for (left, unchanged, right)
     int8_t getKnobPosition(void);
     void   setKnobPosition(int8_t knobPos);
 
+    int16_t  detents(void);        // whole detents since last call, signed
+    int32_t  delta(void);          // accelerated steps since last call, signed
+    uint32_t detentInterval(void); // smoothed microseconds per detent; 0 if idle
+
+    static const uint32_t IDLE_MICROS{250000}; // slower than this starts over
+
+    // curve: `points` entries, kept by pointer (not copied).
+    // interpolate: false = lookup table, true = piecewise linear.
+    // Pass 0 points to turn acceleration off.
+    void setAcceleration(const EncoderAccel* curve, uint8_t points, bool interpolate = false);
+
   private:
     uint8_t _pinA;
     uint8_t _pinB;
     int8_t read(void);
+    int8_t advance(uint32_t now);
+    void detent(int8_t dir, uint32_t now);
+    uint16_t multiplier(uint32_t interval);
     static const int8_t stateTransitionTable[16]; // initialized in Encoder.cpp
-    static int8_t _position;
+    int8_t _position;
     uint8_t oldState = 0;
     uint8_t currentState = 0;
-    int8_t _knobPos;
-    int8_t _oldKnobPos;
+    int8_t _knobPos = 0;
+    int8_t _oldKnobPos = 0;
+
+    // velocity and accumulation
+    int8_t   _lastStep = 0;     // last valid transition (+1/-1), to guess skipped states
+    int8_t   _count = 0;        // quadrature steps toward the next detent
+    int8_t   _lastDir = 0;      // direction of the previous detent
+    uint32_t _lastDetent = 0;   // micros() of the previous detent
+    uint32_t _interval = 0;     // smoothed time between detents; 0 = idle
+    volatile int16_t _pendingDetents = 0;
+    volatile int32_t _pendingDelta = 0;
+    const EncoderAccel* _curve = 0;
+    uint8_t _curvePoints = 0;
+    bool _interpolate = false;
 
 };
 
 #endif // __PANEL_ENCODER_H__
-
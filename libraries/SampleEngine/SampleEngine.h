@@ -0,0 +1,226 @@
+//
+// SampleEngine.h
+// hardware-timer-paced synchronous sampling of several analog channels
+
+// use cases:
+//   1) uniformly sampled data (1-10 kHz per channel) no matter how slow loop() is
+//   2) feeding QuadPressurePad or a GSR channel at a fixed rate
+//   3) logging: every frame is timestamped and numbered, so gaps are visible
+
+// usage:
+//   1) instantiate with the list of analogRead()-able pins
+//   2) begin() with the sample period in microseconds
+//   3) in loop(), read() frames until it returns false
+//   4) poll overruns(), jitterMax() and jitterMean() to check the timing
+//
+//   const uint8_t pins[] = {A0, A1, A2, A3};
+//   SampleEngine<4> engine(pins);
+//   engine.begin(250);              // 4 kHz
+//   ...
+//   SampleEngine<4>::Frame f;
+//   while (engine.read(f)) { use(f.timestamp, f.values); }
+
+// notes:
+//   1) on Teensy 3.x, begin() starts an IntervalTimer; at most one running
+//      engine per SampleEngine<...> type
+//   2) elsewhere begin() returns false; call sample() from your own timer ISR
+//   3) all channels of a frame are read back-to-back inside ONE interrupt,
+//      and the frame is stamped with micros() taken before the first read
+//   4) a frame that finds the queue full is dropped and counted as an overrun;
+//      frame sequence numbers keep counting, so the consumer sees the gap
+//   5) jitter is |actual interval - nominal period| between consecutive ISRs;
+//      before its sum or count would overflow, both are halved, so
+//      jitterMean() stays right on sessions of any length
+//   6) analogRead() time bounds the rate: NUM_CHANNELS reads must fit in one
+//      period (on Teensy 3.x, call analogReadAveraging(1) for ~10us reads)
+
+#ifndef __SAMPLE_ENGINE_H__
+#define __SAMPLE_ENGINE_H__
+
+#include "Arduino.h"
+#include "SampleQueue.h"
+
+#if defined(CORE_TEENSY) && defined(__arm__)
+#define SAMPLE_ENGINE_HAS_INTERVAL_TIMER 1
+#include <IntervalTimer.h>
+#else
+#define SAMPLE_ENGINE_HAS_INTERVAL_TIMER 0
+#endif
+
+template <uint8_t NUM_CHANNELS>
+struct SampleFrame {
+    uint32_t timestamp;            // micros() at the start of acquisition
+    uint32_t sequence;             // frame number since begin()
+    int16_t  values[NUM_CHANNELS]; // one analogRead() per channel
+};
+
+template <uint8_t NUM_CHANNELS, uint16_t QUEUE_SIZE = 64>
+class SampleEngine {
+
+    public:
+
+        typedef SampleFrame<NUM_CHANNELS> Frame;
+
+        // pins: NUM_CHANNELS analogRead()-able pins, sampled in this order
+        explicit SampleEngine(const uint8_t pins[NUM_CHANNELS])
+        {
+            for (uint8_t i = 0; i < NUM_CHANNELS; i++)
+                channelPin[i] = pins[i];
+            period = 0;
+            running = false;
+            sequence = 0;
+            haveLast = false;
+            overrunCount = 0;
+            jitterMaxMicros = 0;
+            jitterSum = 0;
+            jitterCount = 0;
+        }
+
+        ~SampleEngine() { end(); }
+
+        // Start sampling every periodInMicroseconds.
+        // Return false if the period is zero or there is no built-in timer;
+        // in the latter case the engine is armed and sample() may be called
+        // from an external timer interrupt.
+        bool begin(uint32_t periodInMicroseconds)
+        {
+            if (periodInMicroseconds == 0)
+                return false;
+            end();
+            period = periodInMicroseconds;
+            sequence = 0;
+            resetStats();
+            running = true;
+#if SAMPLE_ENGINE_HAS_INTERVAL_TIMER
+            active = this;
+            if (!timer.begin(isr, period)) {
+                running = false;
+                active = 0;
+                return false;
+            }
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        // Stop sampling.  Frames already queued can still be read().
+        void end(void)
+        {
+#if SAMPLE_ENGINE_HAS_INTERVAL_TIMER
+            if (running)
+                timer.end();
+            if (active == this)
+                active = 0;
+#endif
+            running = false;
+        }
+
+        // Acquire one frame.  Call ONLY from the timer interrupt.
+        void sample(void)
+        {
+            if (!running) return;
+            Frame f;
+            f.timestamp = micros();
+            f.sequence = sequence++;
+            for (uint8_t i = 0; i < NUM_CHANNELS; i++)
+                f.values[i] = analogRead(channelPin[i]);
+
+            if (haveLast) {
+                uint32_t dt = f.timestamp - lastTimestamp;
+                uint32_t jitter = (dt > period) ? (dt - period) : (period - dt);
+                if (jitter > jitterMaxMicros)
+                    jitterMaxMicros = jitter;
+                // halving both keeps the mean
+                while (jitterSum > 0xFFFFFFFFUL - jitter || jitterCount == 0xFFFFFFFFUL) {
+                    jitterSum /= 2;
+                    jitterCount /= 2;
+                }
+                jitterSum += jitter;
+                jitterCount++;
+            }
+            lastTimestamp = f.timestamp;
+            haveLast = true;
+
+            if (!queue.push(f))
+                overrunCount++;
+        }
+
+        // Take the oldest frame.  Return false if there is none.
+        bool read(Frame& f) { return queue.pop(f); }
+
+        // Frames waiting to be read().
+        uint16_t available(void) const { return queue.available(); }
+
+        // Timing statistics since begin() or resetStats().
+        // 32-bit reads aren't atomic on 8-bit MCUs: take them with the timer off
+        uint32_t overruns(void) const
+        {
+            noInterrupts();
+            uint32_t n = overrunCount;
+            interrupts();
+            return n;
+        }
+        uint32_t jitterMax(void) const
+        {
+            noInterrupts();
+            uint32_t max = jitterMaxMicros;
+            interrupts();
+            return max;
+        }
+        uint32_t jitterMean(void) const
+        {
+            noInterrupts();
+            uint32_t sum = jitterSum;
+            uint32_t n = jitterCount;
+            interrupts();
+            return n ? sum / n : 0;
+        }
+
+        void resetStats(void)
+        {
+            noInterrupts();
+            overrunCount = 0;
+            jitterMaxMicros = 0;
+            jitterSum = 0;
+            jitterCount = 0;
+            haveLast = false;
+            interrupts();
+        }
+
+        inline bool isRunning(void) const { return running; }
+        inline uint32_t getPeriod(void) const { return period; }
+
+    private:
+
+#if SAMPLE_ENGINE_HAS_INTERVAL_TIMER
+        static void isr(void)
+        {
+            if (active)
+                active->sample();
+        }
+        static SampleEngine* volatile active; // the engine owning the timer
+        IntervalTimer timer;
+#endif
+
+        uint8_t channelPin[NUM_CHANNELS]; // index to the physical pin
+        SampleQueue<Frame, QUEUE_SIZE> queue;
+        uint32_t period;
+        volatile bool running;
+        uint32_t sequence;      // written only by sample()
+        uint32_t lastTimestamp; // written only by sample()
+        volatile bool haveLast;
+        volatile uint32_t overrunCount;
+        volatile uint32_t jitterMaxMicros;
+        volatile uint32_t jitterSum;
+        volatile uint32_t jitterCount;
+
+}; // class SampleEngine
+
+#if SAMPLE_ENGINE_HAS_INTERVAL_TIMER
+template <uint8_t NUM_CHANNELS, uint16_t QUEUE_SIZE>
+SampleEngine<NUM_CHANNELS, QUEUE_SIZE>* volatile
+    SampleEngine<NUM_CHANNELS, QUEUE_SIZE>::active = 0;
+#endif
+
+#endif // __SAMPLE_ENGINE_H__
@@ -0,0 +1,89 @@
+//
+// SampleQueue.h
+// lock-free single-producer/single-consumer ring buffer
+
+// The producer (typically a timer interrupt) calls push(), the consumer
+// (typically loop()) calls pop().  Neither side ever disables interrupts.
+//
+// notes:
+//   1) SIZE must be a power of 2, no larger than 32768 (256 on AVR, where
+//      only 8-bit indices are read and written atomically)
+//   2) holds at most SIZE - 1 items; one slot tells "full" from "empty"
+//   3) exactly ONE producer and ONE consumer, or all bets are off
+//   4) push() and pop() copy items; keep T small (a few dozen bytes)
+
+#ifndef __SAMPLE_QUEUE_H__
+#define __SAMPLE_QUEUE_H__
+
+#include "Arduino.h"
+
+// Keep the compiler from moving item copies across index updates.
+// Single-core MCUs need nothing stronger between an ISR and loop().
+#define SAMPLE_QUEUE_BARRIER() __asm__ __volatile__("" ::: "memory")
+
+#if defined(__AVR__)
+typedef uint8_t SampleQueueIndex;
+#define SAMPLE_QUEUE_MAX_SIZE 256
+#else
+typedef uint16_t SampleQueueIndex;
+#define SAMPLE_QUEUE_MAX_SIZE 32768
+#endif
+
+template <typename T, uint16_t SIZE>
+class SampleQueue {
+
+    public:
+
+        SampleQueue()
+        {
+            head = 0;
+            tail = 0;
+        }
+
+        // Producer side.  Return false (and drop item) if the queue is full.
+        bool push(const T& item)
+        {
+            SampleQueueIndex h = head;
+            SampleQueueIndex next = (h + 1) & MASK;
+            if (next == tail)
+                return false;
+            items[h] = item;
+            SAMPLE_QUEUE_BARRIER();
+            head = next;
+            return true;
+        }
+
+        // Consumer side.  Return false if there is nothing to read.
+        bool pop(T& item)
+        {
+            SampleQueueIndex t = tail;
+            if (t == head)
+                return false;
+            item = items[t];
+            SAMPLE_QUEUE_BARRIER();
+            tail = (t + 1) & MASK;
+            return true;
+        }
+
+        // Number of items waiting.  Exact from either side; a snapshot otherwise.
+        uint16_t available() const
+        {
+            return (head - tail) & MASK;
+        }
+
+        bool isEmpty() const { return head == tail; }
+        uint16_t capacity() const { return SIZE - 1; }
+
+    private:
+
+        static_assert(SIZE >= 2 && SIZE <= SAMPLE_QUEUE_MAX_SIZE && (SIZE & (SIZE - 1)) == 0,
+                      "SampleQueue SIZE must be a power of 2, at most 32768 (256 on AVR)");
+        static const uint16_t MASK{SIZE - 1};
+
+        T items[SIZE];
+        volatile SampleQueueIndex head; // next slot to write (owned by producer)
+        volatile SampleQueueIndex tail; // next slot to read (owned by consumer)
+
+}; // class SampleQueue
+
+#endif // __SAMPLE_QUEUE_H__
@@ -0,0 +1,44 @@
+//
+// Example usage of SampleEngine
+// Samples 4 pressure pads at 2 kHz from a timer interrupt, feeds every frame
+// to a QuadPressurePad, and prints the timing statistics once per second.
+
+#include "SampleEngine.h"
+#include "QuadPressurePad.h"
+#include "EventTimer.h"
+
+const uint8_t padPins[] = {A0, A1, A2, A3};
+const uint32_t sample_period_micros{500}; // 2 kHz
+SampleEngine<4> engine(padPins);
+QuadPressurePad pad(A0, A1, A2, A3);
+EventTimer report(1000000); // 1 second
+
+void setup() {
+    Serial.begin(115200);
+    report.begin();
+    if (!engine.begin(sample_period_micros))
+        Serial.println("no sample timer on this board");
+}
+
+void loop() {
+    // drain everything the timer acquired since the last loop()
+    SampleEngine<4>::Frame frame;
+    while (engine.read(frame)) {
+        pad.update(frame.values);
+    }
+    if (pad.isTouched()) {
+        Serial.println("touch");
+    }
+
+    report.update();
+    if (report.hasExpired()) {
+        Serial.print("overruns: ");
+        Serial.print(engine.overruns());
+        Serial.print(" jitter max/mean (us): ");
+        Serial.print(engine.jitterMax());
+        Serial.print("/");
+        Serial.println(engine.jitterMean());
+    }
+
+    // slow display code can run here without changing the sample rate
+}
@@ -0,0 +1,426 @@
+//
+// SamplePipeline.h
+// source -> filter -> decimator -> sinks, each consuming at its own rate
+
+// use cases:
+//   1) one fast acquisition (e.g. a SampleEngine) feeding several consumers:
+//      touch logic at the full rate, a ~30 Hz display, serial streaming
+//   2) deciding per consumer what happens when it falls behind
+
+// stages:
+//   PipelineSource<T>     pulls from anything with bool read(T&) (SampleEngine)
+//                         or takes push(const T&)
+//   PipelineFilter<T>     out = f(in), e.g. smoothing before decimation
+//   PipelineDecimator<T>  keeps 1 sample in `factor`
+//   PipelineTee<T>        the same samples to several stages
+//   PipelineSink<T, SIZE> a ring buffer read in place by the consumer
+//
+// Samples move between stages as spans (pointer + length).  Stages that
+// change samples (source, filter, decimator) own a fixed buffer of BLOCK
+// samples and hand downstream a span of it; the tee passes spans through
+// untouched; a sink's ring is the only place a sample is stored, and the
+// consumer reads it there with peek()/consume().  Nothing is allocated.
+
+// backpressure, per sink:
+//   DROP_OLDEST  never refuses; when full, the oldest sample is overwritten
+//   BLOCK        refuses when full; the whole pipeline stops pulling, so the
+//                samples wait upstream (a SampleEngine will count overruns
+//                if that goes on too long).  Every other sink behind the
+//                same source waits too: one stalled BLOCK consumer starves
+//                all of them.  Use it only for consumers that keep up.
+//   DOWNSAMPLE   never refuses; keeps 1 in 2 once half full, 1 in 4 once
+//                three-quarters full, and drops the newest when full
+// A stage only ever receives as many samples as it said it has room() for,
+// so nothing is half-processed.
+
+// instrumentation: every stage counts samples in, out, and dropped;
+// read them with stats(), clear them with resetStats(), print them with
+// printStats(Serial, "name", stage.stats()).
+
+// usage:
+//   SampleEngine<4> engine(pins);
+//   PipelineSource<Frame> source;
+//   PipelineDecimator<Frame> decimate(64);
+//   PipelineTee<Frame> tee;
+//   PipelineSink<Frame, 64> touchSink(PIPELINE_DROP_OLDEST);
+//   PipelineSink<Frame, 16> displaySink(PIPELINE_DOWNSAMPLE);
+//   source.connect(tee);
+//   tee.connect(touchSink);
+//   tee.connect(decimate);
+//   decimate.connect(displaySink);
+//   ...
+//   loop() { source.pump(engine); ...; displaySink.peek() ... consume(n); }
+
+#ifndef __SAMPLE_PIPELINE_H__
+#define __SAMPLE_PIPELINE_H__
+
+#include "Arduino.h"
+
+// contiguous samples owned by someone else
+template <typename T>
+struct Span {
+    const T* data;
+    uint16_t length;
+};
+
+struct StageStats {
+    uint32_t in;      // samples received
+    uint32_t out;     // samples passed on (sinks: handed to the consumer)
+    uint32_t dropped; // samples lost to a full sink
+};
+
+inline void printStats(Print& p, const char* name, const StageStats& s)
+{
+    p.print(name);
+    p.print(" in=");
+    p.print(s.in);
+    p.print(" out=");
+    p.print(s.out);
+    p.print(" dropped=");
+    p.println(s.dropped);
+}
+
+enum PipelinePolicy : uint8_t {
+    PIPELINE_DROP_OLDEST,
+    PIPELINE_BLOCK,
+    PIPELINE_DOWNSAMPLE
+};
+
+// anything a sample can be sent to
+template <typename T>
+class PipelineStage {
+
+    public:
+
+        static const uint16_t NO_LIMIT{0xFFFF};
+
+        PipelineStage() { resetStats(); }
+        virtual ~PipelineStage() {}
+
+        // How many samples push() can take right now (NO_LIMIT: any number).
+        virtual uint16_t room(void) const = 0;
+
+        // Take samples.  Never more than room() said.
+        virtual void push(Span<T> samples) = 0;
+
+        const StageStats& stats(void) const { return counters; }
+        void resetStats(void)
+        {
+            counters.in = 0;
+            counters.out = 0;
+            counters.dropped = 0;
+        }
+
+    protected:
+
+        StageStats counters;
+
+}; // class PipelineStage
+
+// a stage with one downstream stage
+template <typename T>
+class PipelineLink : public PipelineStage<T> {
+
+    public:
+
+        PipelineLink() { next = 0; }
+
+        void connect(PipelineStage<T>& stage) { next = &stage; }
+
+    protected:
+
+        uint16_t downstreamRoom(void) const { return next ? next->room() : this->NO_LIMIT; }
+
+        void forward(const T* data, uint16_t length)
+        {
+            if (length == 0)
+                return;
+            this->counters.out += length;
+            if (next) {
+                Span<T> s = {data, length};
+                next->push(s);
+            }
+        }
+
+        PipelineStage<T>* next;
+
+}; // class PipelineLink
+
+// Where samples enter the pipeline.
+template <typename T, uint16_t BLOCK = 16>
+class PipelineSource : public PipelineLink<T> {
+
+    public:
+
+        // Move as many samples from `from` (anything with bool read(T&)) as
+        // the pipeline has room for.  Return how many were moved.
+        template <typename Reader>
+        uint16_t pump(Reader& from)
+        {
+            uint16_t moved = 0;
+            for (;;) {
+                uint16_t want = this->downstreamRoom();
+                if (want > BLOCK)
+                    want = BLOCK;
+                uint16_t n = 0;
+                while (n < want && from.read(buffer[n]))
+                    n++;
+                this->counters.in += n;
+                this->forward(buffer, n);
+                moved += n;
+                if (n < BLOCK)
+                    return moved;
+            }
+        }
+
+        // Offer one sample.  Return false (and count it dropped) if a BLOCK
+        // sink is full.
+        bool push(const T& sample)
+        {
+            this->counters.in++;
+            if (this->downstreamRoom() == 0) {
+                this->counters.dropped++;
+                return false;
+            }
+            buffer[0] = sample;
+            this->forward(buffer, 1);
+            return true;
+        }
+
+        uint16_t room(void) const { return this->downstreamRoom(); }
+        void push(Span<T> samples)
+        {
+            this->counters.in += samples.length;
+            this->forward(samples.data, samples.length);
+        }
+
+    private:
+
+        T buffer[BLOCK];
+
+}; // class PipelineSource
+
+// out = f(in, context), one sample at a time
+template <typename T, uint16_t BLOCK = 16>
+class PipelineFilter : public PipelineLink<T> {
+
+    public:
+
+        typedef void (*Function)(const T& in, T& out, void* context);
+
+        PipelineFilter(Function f, void* context = 0)
+        {
+            fn = f;
+            ctx = context;
+        }
+
+        uint16_t room(void) const { return this->downstreamRoom(); }
+
+        void push(Span<T> samples)
+        {
+            this->counters.in += samples.length;
+            for (uint16_t done = 0; done < samples.length; ) {
+                uint16_t n = samples.length - done;
+                if (n > BLOCK)
+                    n = BLOCK;
+                for (uint16_t i = 0; i < n; i++)
+                    fn(samples.data[done + i], buffer[i], ctx);
+                this->forward(buffer, n);
+                done += n;
+            }
+        }
+
+    private:
+
+        Function fn;
+        void*    ctx;
+        T        buffer[BLOCK];
+
+}; // class PipelineFilter
+
+// keep the last of every `factor` samples
+template <typename T, uint16_t BLOCK = 16>
+class PipelineDecimator : public PipelineLink<T> {
+
+    public:
+
+        explicit PipelineDecimator(uint16_t factor)
+        {
+            m = factor ? factor : 1;
+            phase = 0;
+        }
+
+        // Inputs that produce no more outputs than downstream can take.
+        uint16_t room(void) const
+        {
+            uint32_t r = this->downstreamRoom();
+            if (r == this->NO_LIMIT)
+                return this->NO_LIMIT;
+            r = r * m + (m - 1 - phase);
+            return r < this->NO_LIMIT ? r : this->NO_LIMIT - 1;
+        }
+
+        void push(Span<T> samples)
+        {
+            this->counters.in += samples.length;
+            uint16_t n = 0;
+            for (uint16_t i = 0; i < samples.length; i++) {
+                if (++phase < m)
+                    continue;
+                phase = 0;
+                buffer[n++] = samples.data[i];
+                if (n == BLOCK) {
+                    this->forward(buffer, n);
+                    n = 0;
+                }
+            }
+            this->forward(buffer, n);
+        }
+
+    private:
+
+        uint16_t m;     // decimation factor
+        uint16_t phase; // samples since the last one kept
+        T        buffer[BLOCK];
+
+}; // class PipelineDecimator
+
+// the same span to every connected stage
+template <typename T, uint8_t MAX_OUTPUTS = 4>
+class PipelineTee : public PipelineStage<T> {
+
+    public:
+
+        PipelineTee() { numOutputs = 0; }
+
+        // Return false if there is no room for another output.
+        bool connect(PipelineStage<T>& stage)
+        {
+            if (numOutputs >= MAX_OUTPUTS)
+                return false;
+            outputs[numOutputs++] = &stage;
+            return true;
+        }
+
+        // the slowest BLOCK sink sets the pace for everyone
+        uint16_t room(void) const
+        {
+            uint16_t r = this->NO_LIMIT;
+            for (uint8_t i = 0; i < numOutputs; i++) {
+                uint16_t o = outputs[i]->room();
+                if (o < r)
+                    r = o;
+            }
+            return r;
+        }
+
+        void push(Span<T> samples)
+        {
+            this->counters.in += samples.length;
+            this->counters.out += samples.length;
+            for (uint8_t i = 0; i < numOutputs; i++)
+                outputs[i]->push(samples);
+        }
+
+    private:
+
+        PipelineStage<T>* outputs[MAX_OUTPUTS];
+        uint8_t numOutputs;
+
+}; // class PipelineTee
+
+// The end of the line: a ring of SIZE samples, read in place.
+//
+//   Span<Frame> s = sink.peek();
+//   for (uint16_t i = 0; i < s.length; i++) use(s.data[i]);
+//   sink.consume(s.length);
+template <typename T, uint16_t SIZE>
+class PipelineSink : public PipelineStage<T> {
+
+    public:
+
+        explicit PipelineSink(PipelinePolicy p = PIPELINE_DROP_OLDEST)
+        {
+            policy = p;
+            head = 0;
+            count = 0;
+            thin = 0;
+        }
+
+        uint16_t room(void) const
+        {
+            return policy == PIPELINE_BLOCK ? SIZE - count : this->NO_LIMIT;
+        }
+
+        void push(Span<T> samples)
+        {
+            this->counters.in += samples.length;
+            for (uint16_t i = 0; i < samples.length; i++)
+                store(samples.data[i]);
+        }
+
+        // The oldest unread samples that sit next to each other in the ring.
+        // If available() is bigger, call again after consume().
+        Span<T> peek(void) const
+        {
+            uint16_t tail = (head + SIZE - count) % SIZE;
+            uint16_t n = count;
+            if (tail + n > SIZE)
+                n = SIZE - tail;
+            Span<T> s = {&ring[tail], n};
+            return s;
+        }
+
+        // Done with the first n samples of peek().
+        void consume(uint16_t n)
+        {
+            if (n > count)
+                n = count;
+            count -= n;
+            this->counters.out += n;
+        }
+
+        // Convenience: copy out the oldest sample.
+        bool pop(T& sample)
+        {
+            if (count == 0)
+                return false;
+            sample = *peek().data;
+            consume(1);
+            return true;
+        }
+
+        inline uint16_t available(void) const { return count; }
+        inline uint16_t capacity(void) const { return SIZE; }
+
+    private:
+
+        void store(const T& sample)
+        {
+            if (policy == PIPELINE_DOWNSAMPLE) {
+                // keep 1 in `keep` while congested
+                uint8_t keep = (count >= SIZE * 3 / 4) ? 4 : (count >= SIZE / 2) ? 2 : 1;
+                if (count == SIZE || (++thin % keep) != 0) {
+                    this->counters.dropped++;
+                    return;
+                }
+                thin = 0;
+            } else if (count == SIZE) {
+                // DROP_OLDEST; BLOCK never gets here, see room()
+                count--;
+                this->counters.dropped++;
+            }
+            ring[head] = sample;
+            head = (head + 1) % SIZE;
+            count++;
+        }
+
+        T ring[SIZE];
+        uint16_t head;  // next slot to write
+        uint16_t count; // unread samples
+        uint8_t thin;   // DOWNSAMPLE: samples since the last one kept
+        PipelinePolicy policy;
+
+}; // class PipelineSink
+
+#endif // __SAMPLE_PIPELINE_H__
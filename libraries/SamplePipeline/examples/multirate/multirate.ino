@@ -0,0 +1,116 @@
+//
+// Example usage of SamplePipeline
+// One 2 kHz SampleEngine feeding three consumers at their own rates:
+//   touch logic  every frame, 2 kHz         (drop-oldest: only recent matters)
+//   display      smoothed, ~31 Hz columns   (downsample if drawing falls behind)
+//   serial       smoothed, ~31 Hz lines     (drop-oldest, with room for 2 s)
+// Stage counters are printed once per second; a "serial" drop count means
+// the port couldn't keep up.  None of the sinks uses PIPELINE_BLOCK: a
+// blocking sink would hold back the source, and touch with it.
+
+#include "SampleEngine.h"
+#include "SamplePipeline.h"
+#include "QuadPressurePad.h"
+#include "GSR_Display.h"
+#include "EventTimer.h"
+
+typedef SampleEngine<4>::Frame Frame;
+
+const uint8_t padPins[] = {A0, A1, A2, A3};
+const uint32_t sample_period_micros{500}; // 2 kHz
+const uint16_t decimation{64};            // 2 kHz / 64 = 31.25 Hz
+
+SampleEngine<4> engine(padPins);
+QuadPressurePad pad(A0, A1, A2, A3);
+GSR_Display display(10, 9, 8);
+EventTimer drawTimer(33333);  // ~30 Hz
+EventTimer report(1000000);   // 1 second
+
+// exponential smoothing ahead of the decimator, so the display and log
+// don't alias the 2 kHz noise
+struct Smoother {
+    int32_t state[4];
+} smoother;
+
+void smooth(const Frame& in, Frame& out, void* context)
+{
+    Smoother* s = (Smoother*)context;
+    out = in;
+    for (uint8_t i = 0; i < 4; i++) {
+        s->state[i] += ((int32_t)in.values[i] * 16 - s->state[i]) / 16;
+        out.values[i] = s->state[i] / 16;
+    }
+}
+
+PipelineSource<Frame> source;
+PipelineTee<Frame> fastTee;
+PipelineSink<Frame, 64> touchSink(PIPELINE_DROP_OLDEST);
+PipelineFilter<Frame> smoothing(smooth, &smoother);
+PipelineDecimator<Frame> decimate(decimation);
+PipelineTee<Frame> slowTee;
+PipelineSink<Frame, 8> displaySink(PIPELINE_DOWNSAMPLE);
+PipelineSink<Frame, 64> serialSink(PIPELINE_DROP_OLDEST);
+
+unsigned column{0};
+
+void setup() {
+    Serial.begin(115200);
+    display.begin(ST7735_BLACK);
+    display.setupChart();
+
+    source.connect(fastTee);
+    fastTee.connect(touchSink);
+    fastTee.connect(smoothing);
+    smoothing.connect(decimate);
+    decimate.connect(slowTee);
+    slowTee.connect(displaySink);
+    slowTee.connect(serialSink);
+
+    drawTimer.begin();
+    report.begin();
+    if (!engine.begin(sample_period_micros))
+        Serial.println("no sample timer on this board");
+}
+
+void loop() {
+    source.pump(engine);
+
+    // touch: every frame, read in place
+    for (Span<Frame> s = touchSink.peek(); s.length; s = touchSink.peek()) {
+        for (uint16_t i = 0; i < s.length; i++)
+            pad.update(s.data[i].values);
+        touchSink.consume(s.length);
+    }
+    if (pad.isTouched())
+        Serial.println("touch");
+
+    // serial: a few lines per loop(), so the port never stalls loop()
+    Frame f;
+    for (uint8_t n = 0; n < 4 && serialSink.pop(f); n++) {
+        Serial.print(f.sequence);
+        for (uint8_t i = 0; i < 4; i++) {
+            Serial.print(",");
+            Serial.print(f.values[i]);
+        }
+        Serial.println();
+    }
+
+    // display: one column per tick
+    drawTimer.update();
+    if (drawTimer.hasExpired() && displaySink.pop(f)) {
+        display.clearColumn(column);
+        display.drawPixel(column, f.values[0] * GSR_Display::YMax / 4096);
+        column = (column + 1) % GSR_Display::XMax;
+    }
+
+    report.update();
+    if (report.hasExpired()) {
+        printStats(Serial, "source", source.stats());
+        printStats(Serial, "touch", touchSink.stats());
+        printStats(Serial, "decimate", decimate.stats());
+        printStats(Serial, "display", displaySink.stats());
+        printStats(Serial, "serial", serialSink.stats());
+        Serial.print("engine overruns: ");
+        Serial.println(engine.overruns());
+    }
+}
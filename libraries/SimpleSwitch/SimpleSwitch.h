@@ -24,6 +24,7 @@ class SimpleSwitch
             hiLoTransition = false;
             acceptNextPress = true;
             currentTime = 0;
+            previousTime = 0;
         }
         ~SimpleSwitch() {}
 
@@ -53,6 +54,17 @@ class SimpleSwitch
         // Return the raw button state, which is subject to bounce.
         bool getState() { return currentState; }
 
+        // True if the pin differs from the last sample, i.e. update() has an
+        // edge to pick up at its next sample time.
+        bool isSettling() { return digitalRead(pin) != currentState; }
+
+        // Microseconds until update() takes its next sample; 0 means it's due.
+        uint32_t timeUntilSample(uint32_t now = micros()) const
+        {
+            uint32_t elapsed = now - previousTime;
+            return (elapsed >= debounceInterval) ? 0 : debounceInterval - elapsed;
+        }
+
     private:
         // Return true once, then always false until next valid transition.  Sometimes called
         // an "immediate" debounce, because it responds to the first transition and ignores further
@@ -80,6 +80,15 @@ class SoftwareSwitch {
         // will only return true once (reset by update())
         bool isPressed(void) { return (IsDirty) && (State == LOW); }
 
+        // true while transitions are being ignored; update() must run again
+        // after getTimeout() to start watching the pin again
+        bool isSettling(void) const { return Timeout != 0; }
+        unsigned long getTimeout(void) const { return Timeout; }
+
+        // true if the pin no longer matches getState() and update() is free
+        // to see it (not settling): the next update() will report a change
+        bool hasPendingChange(void) { return !isSettling() && digitalRead(SwitchPin) != State; }
+
     private:
         unsigned SwitchPin;
         unsigned long Interval;
@@ -0,0 +1,246 @@
+//
+// TicklessIdle.h
+// sleep until the earliest EventTimer or switch debounce deadline
+
+// use cases:
+//   1) battery-powered units whose loop() mostly finds nothing to do
+//   2) measuring how late the firmware wakes up for its deadlines
+
+// usage:
+//   1) add() every EventTimer, SoftwareSwitch and SimpleSwitch loop() polls
+//   2) call idle() at the BOTTOM of loop(), after everything was updated
+//   3) optionally attach TicklessIdle::wakeUp to switch pin interrupts so a
+//      press ends the sleep at once instead of at the next deadline
+//
+//   EventTimer blink(500000);
+//   SoftwareSwitch button(2);
+//   TicklessIdle idler;
+//   ...
+//   idler.add(blink);
+//   idler.add(button);
+//   attachInterrupt(2, TicklessIdle::wakeUp, CHANGE);
+//   ...
+//   loop() { blink.update(); button.update(); ...; idler.idle(); }
+
+// notes:
+//   1) the sleep is split in two: a low-power wait that ends `guard`
+//      microseconds early, then a busy-wait to the exact deadline.  The guard
+//      must cover the wake-up time of the low-power wait, so lateness is
+//      bounded by interrupt latency rather than by the sleep mechanism.
+//   2) Teensy 3.x: WFI with an IntervalTimer one-shot programmed for the
+//      deadline.  Other ARM: WFI.  AVR: SLEEP_MODE_IDLE.  The micros() tick
+//      keeps running everywhere, so the core still wakes briefly every
+//      millisecond or so and goes straight back to sleep.
+//   3) on the host (see PinTrace/host) the simulated clock jumps to the
+//      deadline plus HostHAL::setWakeLatency(), so the policy and the
+//      lateness statistics can be checked without hardware.
+//   4) a SimpleSwitch only counts as pending while its pin differs from its
+//      last sample; otherwise it adds no deadline.  A SoftwareSwitch is
+//      pending until its debounce timeout, and after that is due at once if
+//      its pin changed meanwhile (a tap shorter than the debounce interval).
+//   5) nothing pending sleeps maxSleep, which also bounds how long a press on
+//      a pin without a wakeUp interrupt can go unnoticed.
+
+#ifndef __TICKLESS_IDLE_H__
+#define __TICKLESS_IDLE_H__
+
+#include "Arduino.h"
+#include "EventTimer.h"
+#include "SimpleSwitch.h"
+#include "SoftwareSwitch.h"
+
+#if defined(ARDUINO_HOST)
+// the simulated clock does the sleeping
+#elif defined(CORE_TEENSY) && defined(__arm__)
+#include <IntervalTimer.h>
+#define TICKLESS_IDLE_ONE_SHOT 1
+#elif defined(__AVR__)
+#include <avr/sleep.h>
+#endif
+
+class TicklessIdle {
+
+    public:
+
+        static const uint8_t MAX_ITEMS{8};
+
+        // maxSleep: longest sleep when nothing is pending (microseconds)
+        // guard: how early to leave the low-power wait (microseconds)
+        explicit TicklessIdle(uint32_t maxSleep = 100000, uint32_t guard = 50)
+        {
+            maxSleepMicros = maxSleep;
+            guardMicros = guard;
+            numItems = 0;
+            resetStats();
+        }
+
+        // Return false if there is no room for another item.
+        bool add(EventTimer& t) { return addItem(TIMER, &t); }
+        bool add(SoftwareSwitch& s) { return addItem(SOFTWARE_SWITCH, &s); }
+        bool add(SimpleSwitch& s) { return addItem(SIMPLE_SWITCH, &s); }
+
+        // Microseconds until the earliest deadline, at most maxSleep.
+        // 0 means something is already due.
+        uint32_t timeUntilNextDeadline(uint32_t now = micros())
+        {
+            uint32_t earliest = maxSleepMicros;
+            for (uint8_t i = 0; i < numItems && earliest > 0; i++) {
+                uint32_t d = earliest;
+                switch (items[i].kind) {
+                    case TIMER: {
+                        EventTimer* t = static_cast<EventTimer*>(items[i].object);
+                        if (t->isRunning())
+                            d = t->timeUntilExpiry(now);
+                        break;
+                    }
+                    case SOFTWARE_SWITCH: {
+                        SoftwareSwitch* s = static_cast<SoftwareSwitch*>(items[i].object);
+                        // update() stops ignoring the pin once now > timeout;
+                        // a change that came while it was ignoring is due now
+                        if (s->isSettling())
+                            d = (s->getTimeout() >= now) ? s->getTimeout() - now + 1 : 0;
+                        else if (s->hasPendingChange())
+                            d = 0;
+                        break;
+                    }
+                    case SIMPLE_SWITCH: {
+                        SimpleSwitch* s = static_cast<SimpleSwitch*>(items[i].object);
+                        if (s->isSettling())
+                            d = s->timeUntilSample(now);
+                        break;
+                    }
+                }
+                if (d < earliest)
+                    earliest = d;
+            }
+            return earliest;
+        }
+
+        // Sleep until the earliest deadline.  Return the microseconds slept
+        // (0 if something was already due).
+        uint32_t idle(uint32_t now = micros())
+        {
+            uint32_t wait = timeUntilNextDeadline(now);
+            if (wait == 0)
+                return 0;
+            uint32_t deadline = now + wait;
+            // A wakeUp() since the last sleep (say, after button.update() but
+            // before this call) ends this one at once; clear it only after.
+            sleepUntil(deadline);
+            bool byWakeUp = woken();
+            woken() = false;
+
+            // lateness: how long after the deadline we got back to loop()
+            uint32_t after = micros();
+            uint32_t late = (int32_t)(after - deadline) > 0 ? after - deadline : 0;
+            if (!byWakeUp) {
+                if (late > lateMax)
+                    lateMax = late;
+                lateSum += late;
+                wakeCount++;
+            }
+            sleptSum += after - now;
+            return after - now;
+        }
+
+        // Cut the current sleep short.  Safe to call from any interrupt.
+        static void wakeUp(void) { woken() = true; }
+
+        // Statistics since construction or resetStats().
+        uint32_t wakeups(void) const { return wakeCount; }       // deadline wakes
+        uint32_t latenessMax(void) const { return lateMax; }     // microseconds
+        uint32_t latenessMean(void) const { return wakeCount ? lateSum / wakeCount : 0; }
+        uint64_t sleptMicros(void) const { return sleptSum; }
+
+        void resetStats(void)
+        {
+            wakeCount = 0;
+            lateMax = 0;
+            lateSum = 0;
+            sleptSum = 0;
+        }
+
+    private:
+
+        enum Kind : uint8_t { TIMER, SOFTWARE_SWITCH, SIMPLE_SWITCH };
+        struct Item {
+            Kind  kind;
+            void* object;
+        };
+
+        bool addItem(Kind kind, void* object)
+        {
+            if (numItems >= MAX_ITEMS)
+                return false;
+            items[numItems].kind = kind;
+            items[numItems].object = object;
+            numItems++;
+            return true;
+        }
+
+        void sleepUntil(uint32_t deadline)
+        {
+#if defined(ARDUINO_HOST)
+            if (!woken())
+                HostHAL::sleepMicros(deadline - micros());
+#else
+            // low-power part, leaving `guard` early
+            int32_t remaining;
+            while (!woken() && (remaining = deadline - micros()) > (int32_t)guardMicros)
+                waitForInterrupt(remaining - guardMicros);
+            // precise part
+            while (!woken() && (int32_t)(deadline - micros()) > 0) {}
+#endif
+        }
+
+#if !defined(ARDUINO_HOST)
+        // Stop the core until some interrupt fires (at the latest, after
+        // roughly `us` where a one-shot timer is available).
+        static void waitForInterrupt(uint32_t us)
+        {
+#if defined(TICKLESS_IDLE_ONE_SHOT)
+            if (wakeTimer().begin(wakeTimerISR, us))
+                __asm__ __volatile__("wfi");
+#elif defined(__arm__)
+            (void)us;
+            __asm__ __volatile__("wfi");
+#elif defined(__AVR__)
+            (void)us;
+            set_sleep_mode(SLEEP_MODE_IDLE);
+            sleep_enable();
+            sleep_cpu();
+            sleep_disable();
+#else
+            (void)us; // no low-power wait known; busy-wait instead
+#endif
+        }
+#endif
+
+#if defined(TICKLESS_IDLE_ONE_SHOT)
+        static void wakeTimerISR(void) { wakeTimer().end(); }
+        static IntervalTimer& wakeTimer(void)
+        {
+            static IntervalTimer t;
+            return t;
+        }
+#endif
+
+        // shared with wakeUp(), which has no instance to work with
+        static volatile bool& woken(void)
+        {
+            static volatile bool w;
+            return w;
+        }
+
+        uint32_t maxSleepMicros;
+        uint32_t guardMicros;
+        Item     items[MAX_ITEMS];
+        uint8_t  numItems;
+        uint32_t wakeCount;
+        uint32_t lateMax;
+        uint32_t lateSum;
+        uint64_t sleptSum;
+
+}; // class TicklessIdle
+
+#endif // __TICKLESS_IDLE_H__
@@ -0,0 +1,60 @@
+//
+// Example usage of TicklessIdle
+// Blinks two LEDs at different rates and watches a button, sleeping
+// between deadlines instead of spinning loop().
+
+#include "EventTimer.h"
+#include "SoftwareSwitch.h"
+#include "SimpleSwitch.h"
+#include "TicklessIdle.h"
+
+const uint8_t button_pin{2};
+EventTimer slowblink(1000000); // 1 second
+EventTimer fastblink(500000);  // 0.5 second
+EventTimer report(10000000);   // 10 seconds
+SoftwareSwitch button(button_pin);
+TicklessIdle idler;
+
+void setup() {
+    Serial.begin(115200);
+    pinMode(LED_BUILTIN, OUTPUT);
+    button.begin(10000);
+
+    uint32_t current = micros();
+    slowblink.begin(current);
+    fastblink.begin(current);
+    report.begin(current);
+
+    idler.add(slowblink);
+    idler.add(fastblink);
+    idler.add(report);
+    idler.add(button);
+    // wake at once on a press instead of at the next deadline
+    attachInterrupt(button_pin, TicklessIdle::wakeUp, CHANGE);
+}
+
+void loop() {
+    uint32_t current = micros();
+    slowblink.update(current);
+    fastblink.update(current);
+    report.update(current);
+    button.update(current);
+
+    if (slowblink.hasExpired() || fastblink.hasExpired()) {
+        digitalWrite(LED_BUILTIN, !digitalRead(LED_BUILTIN));
+    }
+    if (button.isPressed()) {
+        Serial.println("pressed");
+    }
+    if (report.hasExpired()) {
+        Serial.print("asleep (ms): ");
+        Serial.print((uint32_t)(idler.sleptMicros() / 1000));
+        Serial.print(" wake lateness max/mean (us): ");
+        Serial.print(idler.latenessMax());
+        Serial.print("/");
+        Serial.println(idler.latenessMean());
+    }
+
+    // nothing else to do until the next deadline
+    idler.idle();
+}
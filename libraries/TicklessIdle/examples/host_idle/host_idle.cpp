@@ -0,0 +1,149 @@
+//
+// host_idle.cpp (host)
+// Runs a blink-two-LEDs-and-a-button loop() on the simulated clock, with and
+// without TicklessIdle, and reports how much of the time it could sleep and
+// how late it woke up.
+//
+// build (from this directory):
+//   g++ -std=c++11 -O2 -I../../../PinTrace/host -I../.. -I../../../EventTimer -I../../../SimpleSwitch -I../../../SoftwareSwitch host_idle.cpp -o host_idle
+//
+// The button is pressed every 300ms with a couple of milliseconds of bounce.
+// "press delay" is how long after the real press loop() saw it: without a
+// wakeUp() interrupt on the pin, that is bounded by maxSleep.
+//
+// Then a tap shorter than the debounce interval, with a wakeUp() interrupt
+// on both edges: the release happens while the switch ignores the pin, so
+// it can only be seen once the debounce interval is over.  "seen after" is
+// how long after each edge loop() saw it.
+
+#include "PinTraceReplay.h"
+#include "TicklessIdle.h"
+
+static const uint8_t BUTTON_PIN{2};
+static const uint64_t RUN_MICROS{10000000}; // 10 seconds
+static const uint32_t BUSY_LOOP_MICROS{20};  // what one loop() costs awake
+
+static void pressTrace(PinTraceReplay& trace, std::vector<uint64_t>& pressedAt)
+{
+    trace.add(0, BUTTON_PIN, false, 1);
+    for (uint64_t t = 157321; t + 300000 < RUN_MICROS; t += 300000) {
+        pressedAt.push_back(t);
+        for (int b = 0; b < 5; b++)
+            trace.add(t + b * 300, BUTTON_PIN, false, b % 2 ? 1 : 0);
+        trace.add(t + 100000, BUTTON_PIN, false, 1);
+    }
+}
+
+static void run(const char* name, bool sleep, uint32_t maxSleep, uint32_t wakeLatency)
+{
+    PinTraceReplay trace;
+    std::vector<uint64_t> pressedAt;
+    pressTrace(trace, pressedAt);
+    HostHAL::reset();
+    HostHAL::setWakeLatency(wakeLatency);
+    trace.rewind();
+    trace.advanceTo(0);
+
+    EventTimer slowblink(100000);
+    EventTimer fastblink(25000);
+    SoftwareSwitch button(BUTTON_PIN);
+    TicklessIdle idler(maxSleep, 0);
+    button.begin(10000);
+    slowblink.begin(0);
+    fastblink.begin(0);
+    idler.add(slowblink);
+    idler.add(fastblink);
+    idler.add(button);
+
+    uint32_t loops = 0, expiries = 0, presses = 0;
+    uint64_t timerLateMax = 0, pressDelayMax = 0, pressDelaySum = 0;
+    while (HostHAL::now() < RUN_MICROS) {
+        trace.advanceTo(HostHAL::now());
+        uint32_t now = micros();
+        slowblink.update(now);
+        fastblink.update(now);
+        button.update(now);
+        loops++;
+
+        // how long after its ideal expiry did loop() see each timer?
+        if (fastblink.hasExpired()) {
+            expiries++;
+            uint64_t late = (HostHAL::now() - 1) % 25000;
+            if (late > timerLateMax) timerLateMax = late;
+        }
+        if (slowblink.hasExpired())
+            expiries++;
+        if (button.isPressed() && presses < pressedAt.size()) {
+            uint64_t delay = HostHAL::now() - pressedAt[presses++];
+            pressDelaySum += delay;
+            if (delay > pressDelayMax) pressDelayMax = delay;
+        }
+
+        HostHAL::advanceMicros(BUSY_LOOP_MICROS); // the work itself
+        if (sleep)
+            idler.idle();
+    }
+
+    printf("%-22s %8u %7.1f%% %6u %7llu %9u %9llu %9llu %8llu\n", name, loops,
+           100.0 * idler.sleptMicros() / RUN_MICROS, expiries,
+           (unsigned long long)timerLateMax, presses,
+           (unsigned long long)(presses ? pressDelaySum / presses : 0),
+           (unsigned long long)pressDelayMax,
+           (unsigned long long)idler.latenessMax());
+}
+
+static void tap(const char* name, uint32_t maxSleep)
+{
+    const uint64_t edges[2] = {100000, 103000}; // press, release: a 3 ms tap
+    PinTraceReplay trace;
+    trace.add(0, BUTTON_PIN, false, 1);
+    trace.add(edges[0], BUTTON_PIN, false, 0);
+    trace.add(edges[1], BUTTON_PIN, false, 1);
+    HostHAL::reset();
+    trace.rewind();
+    trace.advanceTo(0);
+
+    SoftwareSwitch button(BUTTON_PIN);
+    TicklessIdle idler(maxSleep, 0);
+    button.begin(10000);
+    idler.add(button);
+
+    uint64_t seen[2] = {0, 0};
+    uint8_t nextEdge = 0;
+    while (HostHAL::now() < 500000) {
+        trace.advanceTo(HostHAL::now());
+        button.update(micros());
+        if (button.hasStateChanged())
+            seen[button.getState() == LOW ? 0 : 1] = HostHAL::now();
+        HostHAL::advanceMicros(BUSY_LOOP_MICROS);
+
+        // the pin interrupt: an edge before the deadline ends the sleep there
+        uint64_t deadline = HostHAL::now() + idler.timeUntilNextDeadline();
+        if (nextEdge < 2 && edges[nextEdge] < deadline) {
+            if (edges[nextEdge] > HostHAL::now())
+                HostHAL::setMicros(edges[nextEdge]);
+            nextEdge++;
+            TicklessIdle::wakeUp();
+        }
+        idler.idle();
+    }
+
+    printf("%-22s %14llu %14llu\n", name,
+           (unsigned long long)(seen[0] ? seen[0] - edges[0] : 0),
+           (unsigned long long)(seen[1] ? seen[1] - edges[1] : 0));
+}
+
+int main()
+{
+    printf("%-22s %8s %8s %6s %7s %9s %9s %9s %8s\n", "", "loops", "asleep",
+           "timers", "late us", "presses", "delay us", "max us", "wake us");
+    run("busy loop", false, 0, 0);
+    run("idle, maxSleep 100ms", true, 100000, 0);
+    run("idle, maxSleep 10ms", true, 10000, 0);
+    run("idle, 30us wake-up", true, 10000, 30);
+
+    printf("\n%-22s %14s %14s\n", "3 ms tap", "press seen us", "release seen us");
+    tap("idle, maxSleep 100ms", 100000);
+    tap("idle, maxSleep 10ms", 10000);
+    return 0;
+}
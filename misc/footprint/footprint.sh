@@ -0,0 +1,142 @@
+#!/bin/sh
+#
+# footprint.sh
+# RAM, flash and stack cost of each library, as a markdown table.
+#
+# Builds misc/footprint/probes.cpp once per library with the static-memory
+# profile (-DPBS_STATIC_MEMORY) and reads the numbers back from the object
+# files, relative to an empty probe:
+#   RAM    .data + .bss: one instance plus any statics it drags in
+#   flash  .text + .data: the code for construction and the probed call
+#   stack  the deepest call path from probe(), frame sizes added up
+#          (-fcallgraph-info=su, GCC 10 or later); core functions
+#          (analogRead(), the TFT driver...) are compiled elsewhere and count
+#          as 0.  Older compilers only give -fstack-usage, so there the
+#          column is every frame in the file added up, marked "*".
+#
+# usage (from the top of the repo):
+#   misc/footprint/footprint.sh      # host, via PinTrace/host and GSR_Display/host
+#
+#   CROSS=avr- \
+#   CXXFLAGS="-mmcu=atmega328p -DF_CPU=16000000L -DARDUINO=10605 -DARDUINO_ARCH_AVR" \
+#   CORE="$ARDUINO/hardware/arduino/avr/cores/arduino $ARDUINO/hardware/arduino/avr/variants/standard" \
+#   EXTRA="$HOME/Arduino/libraries/Adafruit_GFX $HOME/Arduino/libraries/Adafruit_ST7735" \
+#       misc/footprint/footprint.sh > footprint-uno.md
+#
+# Libraries whose probe doesn't compile (e.g. GSR_Display on a device
+# toolchain without the Adafruit libraries in EXTRA) are listed as
+# "not built".
+
+TOP=$(cd "$(dirname "$0")/../.." && pwd)
+LIBS="$TOP/libraries"
+CXX=${CXX:-${CROSS}g++}
+SIZE=${SIZE:-${CROSS}size}
+CORE=${CORE:-$LIBS/PinTrace/host $LIBS/GSR_Display/host}
+CXXFLAGS=${CXXFLAGS:-}
+PROBES="Digipot EventTimer GSR_Display PinTraceRecorder QuadPressurePad
+        RotaryEncoder SampleEngine SamplePipeline SimpleSwitch SoftwareSwitch TicklessIdle"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+INCLUDES=""
+for d in $CORE $EXTRA "$LIBS"/*; do
+    [ -d "$d" ] && INCLUDES="$INCLUDES -I$d"
+done
+
+# the call graph, if the compiler can write one
+CALLGRAPH=""
+if echo 'void f(void) {}' | $CXX $CXXFLAGS -fcallgraph-info=su -x c++ -c - -o "$WORK/cg.o" 2> /dev/null; then
+    CALLGRAPH="-fcallgraph-info=su"
+fi
+
+# Deepest path from probe() in a .ci call graph: "bytes[+]".  "+" if a frame
+# on some reachable path is dynamic or a call is indirect, so the real peak
+# may be higher.  Recursion is cut at the repeated call.
+deepest() {
+    awk '
+    function depth(n,    i, d, best) {
+        if (n in memo) return memo[n]
+        if (n in visiting) return 0
+        visiting[n] = 1
+        best = 0
+        for (i = 1; i <= calls[n]; i++) {
+            d = depth(callee[n, i])
+            if (d > best) best = d
+            if (unsure[callee[n, i]]) unsure[n] = 1
+        }
+        delete visiting[n]
+        return memo[n] = frame[n] + best
+    }
+    /^node:/ {
+        match($0, /title: "[^"]*"/)
+        t = substr($0, RSTART + 8, RLENGTH - 9)
+        if (match($0, /[0-9]+ bytes \(/)) frame[t] = substr($0, RSTART, RLENGTH) + 0
+        if ($0 ~ /bytes \(dynamic/ || t == "__indirect_call") unsure[t] = 1
+        if (t ~ /(^|:)_Z5probev$/) probe = t
+    }
+    /^edge:/ {
+        match($0, /sourcename: "[^"]*"/)
+        s = substr($0, RSTART + 13, RLENGTH - 14)
+        match($0, /targetname: "[^"]*"/)
+        callee[s, ++calls[s]] = substr($0, RSTART + 13, RLENGTH - 14)
+    }
+    END { printf "%d%s\n", depth(probe), unsure[probe] ? "+" : "" }
+    ' "$1"
+}
+
+# build one probe; print "ram flash stack" or nothing on failure
+measure() {
+    name=$1
+    obj="$WORK/$name.o"
+    $CXX -std=gnu++11 -Os -ffunction-sections -fdata-sections -fstack-usage $CALLGRAPH \
+        -DPBS_STATIC_MEMORY -DPROBE_$name $CXXFLAGS $INCLUDES \
+        -c "$TOP/misc/footprint/probes.cpp" -o "$obj" 2> "$WORK/$name.err" || return
+    $SIZE "$obj" | awk 'NR == 2 { printf "%d %d ", $2 + $3, $1 + $2 }'
+    if [ -n "$CALLGRAPH" ]; then
+        deepest "$WORK/$name.ci"
+        return
+    fi
+    # static initialization runs once before setup(), not on the probed path
+    grep -v -e '_GLOBAL__sub_I' -e '__static_initialization' "$WORK/$name.su" |
+        awk -F'\t' '{ sum += $2 } /dynamic/ { dyn = "+" } END { printf "%d%s\n", sum, dyn }'
+}
+
+base=$(measure baseline)
+if [ -z "$base" ]; then
+    echo "footprint.sh: can't build the empty probe with $CXX:" >&2
+    cat "$WORK/baseline.err" >&2
+    exit 1
+fi
+set -- $base
+baseRam=$1
+baseFlash=$2
+baseStack=${3%+}
+
+echo "Footprint: \`$CXX $CXXFLAGS\`, static-memory profile"
+echo
+if [ -n "$CALLGRAPH" ]; then
+    echo "| library | RAM (bytes) | flash (bytes) | stack, deepest path of the probed call (bytes) |"
+else
+    echo "| library | RAM (bytes) | flash (bytes) | stack, every frame in the file* (bytes) |"
+fi
+echo "|:--------|------------:|--------------:|------------------------------------------------:|"
+for p in $PROBES; do
+    m=$(measure "$p")
+    if [ -z "$m" ]; then
+        echo "| $p | not built | | |"
+        continue
+    fi
+    set -- $m
+    stack=${3%+}
+    echo "| $p | $(($1 - baseRam)) | $(($2 - baseFlash)) | $((stack - baseStack))${3#$stack} |"
+done
+echo
+if [ -n "$CALLGRAPH" ]; then
+    echo "Stack leaves out the Arduino core; \"+\" marks a path through a frame whose"
+    echo "size depends on arguments, or through an indirect call."
+else
+    echo "*This compiler has no -fcallgraph-info: stack is every frame in the probe"
+    echo "added up, an upper bound that leaves out the Arduino core; \"+\" marks"
+    echo "frames whose size depends on arguments."
+fi
@@ -0,0 +1,94 @@
+//
+// probes.cpp
+// One tiny program per library for footprint.sh: a global instance (RAM)
+// and a call to its busiest method (flash, stack).  Compiled once per
+// PROBE_<name>; nothing here runs.
+
+#include "Arduino.h"
+
+#define PROBE __attribute__((noinline, used))
+
+#if defined(PROBE_Digipot)
+#include "Digipot_MAX5160.h"
+Digipot instance(3, 5, 18);
+PROBE void probe(void) { instance.wiperMove(1); }
+
+#elif defined(PROBE_EventTimer)
+#include "EventTimer.h"
+EventTimer instance(1000);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_GSR_Display)
+#include "GSR_Display.cpp"
+GSR_Display instance(10, 9, 8);
+PROBE void probe(void) { instance.statusBar("0123456789"); instance.drawPixel(1, 1); }
+
+#elif defined(PROBE_PinTraceRecorder)
+#include "PinTrace.h"
+PinTraceRecorder instance(Serial);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_QuadPressurePad)
+#include "QuadPressurePad.h"
+QuadPressurePad instance(A0, A1, A2, A3);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_RotaryEncoder)
+#include "RotaryEncoder.cpp"
+RotaryEncoder instance(3, 4);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_SampleEngine)
+#include "SampleEngine.h"
+const uint8_t pins[4] = {A0, A1, A2, A3};
+SampleEngine<4> instance(pins);
+PROBE void probe(void) { instance.sample(); }
+
+#elif defined(PROBE_SamplePipeline)
+#include "SamplePipeline.h"
+#include "SampleEngine.h"
+typedef SampleFrame<4> Frame;
+PipelineSource<Frame> source;
+PipelineTee<Frame> instance;
+PipelineDecimator<Frame> decimate(64);
+PipelineSink<Frame, 64> fast(PIPELINE_DROP_OLDEST);
+PipelineSink<Frame, 16> slow(PIPELINE_BLOCK);
+PROBE void probe(void)
+{
+    source.connect(instance);
+    instance.connect(fast);
+    instance.connect(decimate);
+    decimate.connect(slow);
+    Frame f = {0, 0, {0, 0, 0, 0}};
+    source.push(f);
+}
+
+#elif defined(PROBE_SimpleSwitch)
+#include "SimpleSwitch.h"
+SimpleSwitch instance(2);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_SoftwareSwitch)
+#include "SoftwareSwitch.h"
+SoftwareSwitch instance(2);
+PROBE void probe(void) { instance.update(); }
+
+#elif defined(PROBE_TicklessIdle)
+#include "TicklessIdle.h"
+TicklessIdle instance;
+PROBE void probe(void) { instance.idle(); }
+
+#else
+// baseline: what every probe costs before any library is involved
+PROBE void probe(void) {}
+#endif
+
+// in every probe, so that whatever the core brings along cancels out
+PROBE void core(void)
+{
+    pinMode(0, INPUT);
+    digitalWrite(0, digitalRead(0));
+    noInterrupts();
+    Serial.print(analogRead(0) + micros());
+    interrupts();
+}